@@ -0,0 +1,18 @@
+#ifndef AVX64_H
+#define AVX64_H
+
+#include "../include/grid.h"
+
+// The AVX2 engine is only built for x86 targets, the others keep the scalar kernels
+#if defined(__x86_64__) || defined(__i386__)
+#define AVX64_ENABLED 1
+#else
+#define AVX64_ENABLED 0
+#endif
+
+// 64x64 engine functions, on the packed rows and columns of the grid
+bool avx64_supported(void);
+bool avx64_consistent(t_grid* g);
+bool avx64_propagate(t_grid* g);
+
+#endif // AVX64_H
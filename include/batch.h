@@ -0,0 +1,16 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "../include/takuzu.h"
+#include "../include/rng.h"
+
+// Maximum number of worker threads accepted by -j
+#define MAX_JOBS 256
+
+// Generation of one grid with the settings of the options
+bool generate_grid(t_grid* grid, const takuzu_Options* options, t_rng* rng);
+
+// Batch generation: options->count grids on options->jobs threads, streamed to fd
+int generate_batch(const takuzu_Options* options, FILE* fd);
+
+#endif // BATCH_H
@@ -0,0 +1,126 @@
+#ifndef BITLINE_H
+#define BITLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Packed lines: a row or a column of the grid is stored as two bitsets, 'filled'
+ * (bit set if the cell holds a value) and 'ones' (bit set if the cell holds '1'),
+ * using LINE_WORDS(length) 64-bit words each. Cell i of the line is bit i % 64 of
+ * word i / 64, and the bits past the end of the line are always 0.
+ * Lines of up to 64 cells fit in a single word and take the fast paths below.
+ */
+
+// Number of 64-bit words needed to store a line of the given length
+#define LINE_WORDS(length) (((length) + 63) / 64)
+
+
+// Mask of the valid bits in the last word of a line
+static inline uint64_t line_last_mask(int length) {
+    int bits = length % 64;
+    return (bits == 0) ? ~0ULL : ((1ULL << bits) - 1);
+}
+
+
+// Number of bits set in a packed line
+static inline int line_popcount(const uint64_t* bits, int words) {
+    if (words == 1) {
+        return __builtin_popcountll(bits[0]);
+    }
+    int count = 0;
+    for (int w = 0; w < words; w++) {
+        count += __builtin_popcountll(bits[w]);
+    }
+    return count;
+}
+
+
+// True if every cell of the line is filled
+static inline bool line_is_full(const uint64_t* filled, int length) {
+    int words = LINE_WORDS(length);
+    for (int w = 0; w < words - 1; w++) {
+        if (filled[w] != ~0ULL) {
+            return false;
+        }
+    }
+    return filled[words - 1] == line_last_mask(length);
+}
+
+
+// True if two packed lines are equal
+static inline bool line_equal(const uint64_t* a, const uint64_t* b, int words) {
+    if (words == 1) {
+        return a[0] == b[0];
+    }
+    for (int w = 0; w < words; w++) {
+        if (a[w] != b[w]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// True if a complete line holds the values of a partial line on its filled cells
+static inline bool line_extends(const uint64_t* full_ones, const uint64_t* filled, const uint64_t* ones, int words) {
+    for (int w = 0; w < words; w++) {
+        if ((full_ones[w] & filled[w]) != ones[w]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Orders two packed lines (for sorting), returns <0, 0 or >0
+static inline int line_compare(const uint64_t* a, const uint64_t* b, int words) {
+    for (int w = 0; w < words; w++) {
+        if (a[w] != b[w]) {
+            return (a[w] < b[w]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+
+// Word w of a line shifted towards lower indices by 'shift' bits (1 or 2)
+static inline uint64_t line_shifted_word(const uint64_t* bits, int words, int w, int shift) {
+    uint64_t word = bits[w] >> shift;
+    if (w + 1 < words) {
+        word |= bits[w + 1] << (64 - shift);
+    }
+    return word;
+}
+
+
+// True if the value mask has three consecutive bits set
+static inline bool mask_has_triple(const uint64_t* mask, int words) {
+    if (words == 1) {
+        return (mask[0] & (mask[0] >> 1) & (mask[0] >> 2)) != 0;
+    }
+    for (int w = 0; w < words; w++) {
+        uint64_t triple = mask[w] & line_shifted_word(mask, words, w, 1) & line_shifted_word(mask, words, w, 2);
+        if (triple != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// True if the line has three consecutive '0' or three consecutive '1'
+static inline bool line_has_triple(const uint64_t* filled, const uint64_t* ones, int words) {
+    if (words == 1) {
+        uint64_t zeros = filled[0] & ~ones[0];
+        return (zeros & (zeros >> 1) & (zeros >> 2)) != 0 ||
+            (ones[0] & (ones[0] >> 1) & (ones[0] >> 2)) != 0;
+    }
+    uint64_t zeros[words];
+    for (int w = 0; w < words; w++) {
+        zeros[w] = filled[w] & ~ones[w];
+    }
+    return mask_has_triple(zeros, words) || mask_has_triple(ones, words);
+}
+
+#endif // BITLINE_H
@@ -0,0 +1,46 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "../include/solver.h"
+
+// Time between two checkpoints of a long search, in milliseconds
+#ifndef CHECKPOINT_INTERVAL_MS
+#define CHECKPOINT_INTERVAL_MS 30000
+#endif
+
+// Version of the checkpoint files, on their first line
+#define CHECKPOINT_VERSION 3
+
+// Search saved in a checkpoint file: the cells filled by the search in order, the
+// decision stack and the counters, enough to resume it exactly where it stopped
+struct t_checkpoint {
+    mode_t mode;            // MODE_ALL or MODE_COUNT
+    int rows;
+    int cols;
+    tier_t propagation;     // Propagation of the search, which shapes its tree
+    int probe_depth;
+    long probe_budget;
+    uint64_t nodes;         // Nodes propagated so far
+    uint64_t solutions;     // Solutions found so far
+    uint64_t handed;        // Solutions handed out so far (MODE_ALL)
+    bool backtrack;         // State flags of the solver
+    bool finished;
+    char* cells;            // Cells of the grid, row by row: the clues and the cells of the trail
+    char* first;            // First solution handed out, row by row (NULL: none)
+    int* trail;             // Cells filled by the search, in order
+    int trail_length;
+    t_frame* stack;         // Decision stack
+    int depth;
+};
+
+typedef struct t_checkpoint t_checkpoint;
+
+// Checkpoint functions
+bool checkpoint_write(const char* filename, const t_solver* solver, const takuzu_Options* options,
+    uint64_t handed, const t_grid* first);
+bool checkpoint_read(const char* filename, t_checkpoint* checkpoint);
+bool checkpoint_matches(const t_checkpoint* checkpoint, const t_grid* grid, const takuzu_Options* options);
+void checkpoint_restore(const t_checkpoint* checkpoint, t_solver* solver);
+void checkpoint_free(t_checkpoint* checkpoint);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,30 @@
+#ifndef DPCOUNT_H
+#define DPCOUNT_H
+
+#include "../include/grid.h"
+#include "../include/solver.h"
+
+// Widest grid counted by the transfer matrix: a row is a 64-bit mask
+#define DP_MAX_COLS 64
+
+// Tallest grid counted by the transfer matrix: column counts are stored on a byte
+#define DP_MAX_ROWS 510
+
+// Most candidate rows enumerated for one row of the grid
+#define DP_MAX_ROW_CANDIDATES (1 << 16)
+
+// Most states kept for one row of the transfer matrix
+#define DP_MAX_STATES (1 << 22)
+
+// Slots of the state table between two reads of the cancellation flag
+#define DP_POLL_INTERVAL 4096
+
+// Solution count of the transfer matrix, wide enough for the empty 14x14 grid and beyond
+typedef unsigned __int128 dp_count_t;
+
+// Transfer-matrix counting functions
+bool dp_count_solutions(const t_grid* grid, const atomic_bool* cancel, dp_count_t* count);
+void dp_count_format(dp_count_t count, char* buffer, size_t size);
+void count_solutions_dp(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats);
+
+#endif // DPCOUNT_H
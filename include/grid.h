@@ -2,6 +2,14 @@
 #define GRID_H
 
 #include "../include/takuzu.h"
+#include "../include/rng.h"
+#include "../include/bitline.h"
+
+// Number of random permutations tried before a fill request is declared infeasible
+#define MAX_FILL_ATTEMPTS 100
+
+// Most empty cells of a line whose completions the distinct lines rule enumerates
+#define DISTINCT_MAX_EMPTY 6
 
 // Structure to represent a choice in the grid
 typedef struct {
@@ -10,6 +18,57 @@ typedef struct {
     char choice;  // '0' or '1' to represent choices
 } choice_t;
 
+// Writes a cell into both copies of the cells, row by row and column by column
+static inline void grid_write_cell(t_grid* g, int i, int j, char v) {
+    g->grid[(size_t)i * g->cols + j] = v;
+    g->columns[(size_t)j * g->rows + i] = v;
+}
+
+// Writes a cell value into the packed lines and the counts of empty cells of the grid
+void grid_set_bits(int i, int j, t_grid* g, char v);
+
+// Bound check of the unchecked accessors, only done in the debug build
+static inline void grid_check_cell(const t_grid* g, int i, int j, const char* function) {
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+    if (i < 0 || i >= g->rows || j < 0 || j >= g->cols) {
+        fprintf(stderr, "Error: Coordinates (%d, %d) are out of bounds for the grid in %s.\n", i, j, function);
+        abort();
+    }
+#else
+    (void)g;
+    (void)i;
+    (void)j;
+    (void)function;
+#endif
+}
+
+// Value of the cell (i, j), without the checks of get_cell: the caller handles the edges of the grid
+static inline char grid_cell(const t_grid* g, int i, int j) {
+    grid_check_cell(g, i, j, "grid_cell");
+    return g->grid[(size_t)i * g->cols + j];
+}
+
+// Fills the cell (i, j) with '0' or '1' like set_cell, without its checks, for the engine
+static inline void grid_fill_cell(t_grid* g, int i, int j, char v) {
+    grid_check_cell(g, i, j, "grid_fill_cell");
+    int index = i * g->cols + j;
+    if (g->trail != NULL && g->grid[index] == '_') {
+        g->trail[g->trail_length++] = index;
+    }
+    grid_write_cell(g, i, j, v);
+    grid_set_bits(i, j, g, v);
+}
+
+// Cells of a row, or of a column in the column-major copy, as one contiguous line
+static inline const char* grid_line(const t_grid* g, bool is_row, int index) {
+    return is_row ? g->grid + (size_t)index * g->cols : g->columns + (size_t)index * g->rows;
+}
+
+// True if two complete rows, or two complete columns, are identical
+static inline bool grid_has_identical_lines(const t_grid* g) {
+    return g->full_rows.duplicates != 0 || g->full_cols.duplicates != 0;
+}
+
 // Function or prototypes for grid operations
 
 // Grid copying functions
@@ -18,6 +77,14 @@ void grid_copy(const t_grid* source_grid, t_grid* destination_grid);
 // Cell manipulation functions
 void set_cell(int i, int j, t_grid* g, char v);
 char get_cell(int i, int j, t_grid* g);
+void grid_clear_cell(int i, int j, t_grid* g);
+void grid_reset(t_grid* g);
+void grid_sync_bits(t_grid* g);
+
+// Trail functions, to undo the cells filled by a search
+void grid_trail_start(t_grid* g);
+void grid_trail_stop(t_grid* g);
+void grid_undo(t_grid* g, int mark);
 
 // Consistency checking functions
 bool is_consistent(t_grid* g);
@@ -36,13 +103,17 @@ bool apply_all_zeros_filled_rows(t_grid* g);
 bool apply_all_zeros_filled_columns(t_grid* g);
 bool apply_all_ones_filled_rows(t_grid* g);
 bool apply_all_ones_filled_columns(t_grid* g);
-void apply_heuristics_until_stable(t_grid* g);
+bool apply_distinct_lines(t_grid* g);
+bool apply_distinct_lines_since(t_grid* g, int mark);
+bool apply_heuristics_once(t_grid* g);
+int apply_heuristics_until_stable(t_grid* g);
 
 // Grid generation functions, and check the consistency after a choice
 bool check_consistency_after_placement(t_grid* g, int row, int col, char cell_value);
-char place_cell_strategically(t_grid* g, int row, int col);
-void generate_random_grid(t_grid* g, int percentage);
-void generate_random_grid_with_solution(t_grid* g, int percentage);
+char place_cell_strategically(t_grid* g, int row, int col, t_rng* rng);
+bool is_placement_consistent(t_grid* g, int row, int col, char value);
+bool generate_random_grid(t_grid* g, int percentage, const atomic_bool* cancel, t_rng* rng);
+bool generate_random_grid_with_solution(t_grid* g, int percentage, const atomic_bool* cancel, t_rng* rng);
 
 // Grid choice functions
 void grid_choice_apply(t_grid* grid, choice_t choice);
@@ -57,10 +128,4 @@ choice_t grid_choice_deterministic(t_grid* grid, char choice);
 choice_t grid_choice_ordered(t_grid* grid, char choice);
 bool grid_choice(t_grid* grid, char choice);
 
-// Backtracking functions
-t_grid* grid_solver_backtracking(t_grid* grid, mode_t mode, int* solution_count);
-void find_first_solution(t_grid* grid, const mode_t mode);
-void find_all_solutions(t_grid* grid, const mode_t mode);
-t_grid* grid_solver(t_grid* grid, const mode_t mode);
-
 #endif // GRID_H
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "../include/grid.h"
+
+// Hot functions of the solver, specialized for one size of grid
+typedef struct {
+    int size;                       // Size of the square grids handled (0: any grid)
+    bool (*consistent)(t_grid* g);  // Same checks as is_consistent
+    bool (*propagate)(t_grid* g);   // Basic rules, one round or more, true if a cell was filled
+} t_kernels;
+
+// Kernels of grid.c, for any grid
+extern const t_kernels kernels_generic;
+
+// Kernel functions
+const t_kernels* kernels_select(const t_grid* g);
+
+#endif // KERNELS_H
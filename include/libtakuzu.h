@@ -0,0 +1,93 @@
+#ifndef LIBTAKUZU_H
+#define LIBTAKUZU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Solver and generator of takuzu grids as a library (libtakuzu.a, libtakuzu.so).
+ *
+ * Every call works on a context, which holds the settings of the calls and the current
+ * grid; the library keeps no other state. A context is used by one thread at a time,
+ * and any number of contexts can be used concurrently from different threads. Only
+ * tk_cancel and tk_iter_cancel may be called from another thread than the one using
+ * the context or the iterator.
+ */
+
+// Context of the library: settings and current grid
+typedef struct tk_ctx tk_ctx;
+
+// Iterator over the solutions of a grid, pulled one at a time
+typedef struct tk_iter tk_iter_t;
+
+// Result of a call
+typedef enum {
+    TK_OK,
+    TK_NO_SOLUTION,         // The grid has no solution (for an iterator: no more solution)
+    TK_ERROR_ARGUMENT,      // Invalid argument (NULL pointer, size, level, depth...)
+    TK_ERROR_PARSE,         // The text holds no valid grid
+    TK_ERROR_NO_GRID,       // The context holds no grid yet
+    TK_ERROR_INCONSISTENT,  // The grid breaks a rule of the game
+    TK_ERROR_GENERATION,    // The generator could not fill the requested cells
+    TK_BUDGET_EXHAUSTED,    // The search stopped at its node or time limit: the result is unknown
+    TK_CANCELLED            // The search was stopped by tk_cancel or tk_iter_cancel: the result is unknown
+} tk_status;
+
+// Called with each solution: rows x cols cells '0' and '1', row by row (not a string),
+// numbered from 1. Returning false stops the enumeration.
+typedef bool (*tk_solution_fn)(const char* cells, int rows, int cols, uint64_t index, void* data);
+
+// Settings of a generation, as the options of takuzu -g
+typedef struct {
+    int rows;                   // Even number of rows, 2 to 4096
+    int cols;                   // Even number of columns, 2 to 4096
+    int percentage;             // Cells filled, 0 to 100, when no difficulty is given (-n)
+    bool solvable;              // Only grids with at least one solution (-u)
+    const char* difficulty;     // "easy", "medium" or "hard": a puzzle of that difficulty (-d), NULL otherwise
+    uint64_t seed;              // Seed of the random streams (-s)
+    uint64_t index;             // Index of the grid in the stream: grid k of takuzu -c is index k
+} tk_generate_options;
+
+// Contexts
+tk_ctx* tk_ctx_new(void);
+void tk_ctx_free(tk_ctx* ctx);
+
+// Settings of the context: verbose messages on stderr, and propagation of the solver
+// ("basic", "lines" or "probe", NULL to keep the current one) as -L, -p and -P
+void tk_set_verbose(tk_ctx* ctx, bool verbose);
+tk_status tk_set_propagation(tk_ctx* ctx, const char* level, int probe_depth, long probe_budget);
+
+// Budget of each solve, count or iterator of the context, as --max-nodes and --timeout-ms
+// (0: no limit). A solve stopped by its budget returns TK_BUDGET_EXHAUSTED, with the
+// solutions found so far in its count.
+tk_status tk_set_limits(tk_ctx* ctx, uint64_t max_nodes, long timeout_ms);
+
+// Stops the solve, count or generation running on the context in another thread, which
+// returns TK_CANCELLED; the next call of the context runs normally. Safe from a signal handler.
+void tk_cancel(tk_ctx* ctx);
+
+// Current grid: set from the text of a grid file, or generated
+tk_status tk_parse(tk_ctx* ctx, const char* text);
+tk_status tk_generate(tk_ctx* ctx, const tk_generate_options* options);
+int tk_rows(const tk_ctx* ctx);
+int tk_cols(const tk_ctx* ctx);
+const char* tk_cells(const tk_ctx* ctx);
+
+// Solving: without a callback, the first solution replaces the grid of the context;
+// with one, every solution is handed to it and the grid keeps the first one
+tk_status tk_solve(tk_ctx* ctx, tk_solution_fn callback, void* data, uint64_t* count);
+tk_status tk_count(tk_ctx* ctx, uint64_t* count);
+
+// Iterators: each one searches its own copy of the grid of the context, in the order of
+// tk_solve, and suspends the search between two calls of tk_iter_next. An iterator
+// takes O(rows x cols) memory and is independent from its context once created; the
+// budget of the context covers its whole enumeration. A cancelled iterator stays so.
+tk_status tk_iter_new(tk_ctx* ctx, tk_iter_t** iter);
+tk_status tk_iter_next(tk_iter_t* iter, char* out_grid);
+void tk_iter_cancel(tk_iter_t* iter);
+void tk_iter_free(tk_iter_t* iter);
+
+// Name of a result
+const char* tk_status_name(tk_status status);
+
+#endif // LIBTAKUZU_H
@@ -0,0 +1,23 @@
+#ifndef LINESET_H
+#define LINESET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Complete rows (or columns) of a grid, hashed on their packed 'ones' bitsets
+typedef struct {
+    int* slots;         // Line index per slot (-1: empty), open addressing with linear probing
+    int mask;           // Number of slots minus one (a power of two minus one)
+    int count;          // Lines in the set
+    int duplicates;     // Lines equal to another line of the set inserted before them
+} t_lineset;
+
+// Line set functions
+void lineset_init(t_lineset* set, int lines);
+void lineset_free(t_lineset* set);
+void lineset_clear(t_lineset* set);
+void lineset_insert(t_lineset* set, const uint64_t* ones, int words, int line);
+void lineset_remove(t_lineset* set, const uint64_t* ones, int words, int line);
+bool lineset_contains(const t_lineset* set, const uint64_t* ones, int words, const uint64_t* bits);
+
+#endif // LINESET_H
@@ -0,0 +1,56 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+// Logging levels, chosen at compile time with -DLOG_LEVEL=...
+#define LOG_LEVEL_ERROR 0   // Errors only, printed whatever the options
+#define LOG_LEVEL_INFO 1    // Messages of the verbose mode (release build)
+#define LOG_LEVEL_DEBUG 2   // Diagnostics of the engine and checked cell accesses (debug build)
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Verbose mode of the calling thread, set by the command line, by the workers of a
+// batch and by each call of the library from the options of its context
+extern _Thread_local bool log_verbose;
+
+// Messages of the verbose mode, printed on stderr when log_verbose is set
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...)                        \
+    do {                                     \
+        if (log_verbose) {                   \
+            fprintf(stderr, __VA_ARGS__);    \
+        }                                    \
+    } while (0)
+#else
+#define LOG_INFO(...)                        \
+    do {                                     \
+        if (0) {                             \
+            fprintf(stderr, __VA_ARGS__);    \
+        }                                    \
+    } while (0)
+#endif
+
+// Diagnostics of the engine, compiled out below the debug level: they sit in the
+// loops of the solver and cost nothing in a release build (the arguments are still
+// type-checked)
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...)                       \
+    do {                                     \
+        if (log_verbose) {                   \
+            fprintf(stderr, __VA_ARGS__);    \
+        }                                    \
+    } while (0)
+#else
+#define LOG_DEBUG(...)                       \
+    do {                                     \
+        if (0) {                             \
+            fprintf(stderr, __VA_ARGS__);    \
+        }                                    \
+    } while (0)
+#endif
+
+#endif // LOG_H
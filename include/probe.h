@@ -0,0 +1,22 @@
+#ifndef PROBE_H
+#define PROBE_H
+
+#include "../include/rating.h"
+
+// Deepest nesting of probes accepted on the command line
+#define PROBE_MAX_DEPTH 3
+
+// Propagation run after each tentative value, to a fixpoint. 'mark' is the trail
+// length before the value was set, when the grid was propagated.
+typedef rule_result_t (*t_probe_propagation)(t_grid* g, int mark);
+
+// Bounds of failed-literal probing
+typedef struct {
+    int depth;      // 1: a probe only propagates, d: it also probes with depth d - 1 (0: no probing)
+    long budget;    // Values tried per call, nested probes included (0: no limit)
+} t_probe_limits;
+
+// Probing function
+rule_result_t probe_grid(t_grid* g, t_probe_propagation propagate, const t_probe_limits* limits);
+
+#endif // PROBE_H
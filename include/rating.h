@@ -0,0 +1,42 @@
+#ifndef RATING_H
+#define RATING_H
+
+#include "../include/grid.h"
+
+// Result of a propagation rule or of a tiered propagation
+typedef enum {
+    RULE_CONFLICT,  // The grid has no solution
+    RULE_STABLE,    // Nothing more can be deduced
+    RULE_CHANGED,   // At least one cell was filled
+    RULE_SOLVED     // The grid is complete and consistent
+} rule_result_t;
+
+// Difficulty rating of a grid
+typedef struct {
+    tier_t tier;        // Hardest tier needed (TIER_BRANCH if propagation is stuck)
+    int rounds;         // Total number of propagation rounds that filled cells
+    int basic_rounds;   // Rounds of the basic rules
+    int line_rounds;    // Rounds where line completion or distinct lines was needed
+    int probe_rounds;   // Rounds where probing was needed
+    bool solved;        // Solved without branching
+    bool conflict;      // The grid has no solution
+} t_rating;
+
+// Stronger propagation tiers
+bool line_domains(const char* line, int length, unsigned char* domains);
+rule_result_t apply_line_completion(t_grid* g);
+rule_result_t apply_line_completion_since(t_grid* g, int mark);
+rule_result_t apply_probing(t_grid* g);
+rule_result_t propagate_tiers(t_grid* g, tier_t max_tier, t_rating* rating);
+
+// Rating functions
+void rate_grid(const t_grid* g, tier_t max_tier, t_rating* rating);
+void rating_print(const t_rating* rating, FILE* fd);
+const char* difficulty_name(tier_t tier);
+bool parse_difficulty(const char* name, tier_t* tier);
+
+// Generation with a target difficulty
+bool generate_random_solution(t_grid* g, const atomic_bool* cancel, t_rng* rng);
+bool generate_grid_with_difficulty(t_grid* g, tier_t target, const atomic_bool* cancel, t_rng* rng);
+
+#endif // RATING_H
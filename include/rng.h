@@ -0,0 +1,21 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// State of a xoshiro256** pseudo-random number generator
+typedef struct {
+    uint64_t s[4];
+} t_rng;
+
+// Seeding functions
+void rng_seed(t_rng* rng, uint64_t seed, uint64_t stream);
+uint64_t rng_default_seed(void);
+
+// Drawing functions
+uint64_t rng_next(t_rng* rng);
+uint32_t rng_below(t_rng* rng, uint32_t bound);
+int rng_bit(t_rng* rng);
+void rng_shuffle(t_rng* rng, int* array, int length);
+
+#endif // RNG_H
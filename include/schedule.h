@@ -0,0 +1,47 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "../include/kernels.h"
+#include "../include/probe.h"
+
+// Rules of the scheduler, from the cheapest to the most expensive
+#define SCHEDULE_RULES 11
+
+// Yield of a rule that finds something at every run, in fixed point
+#define SCHEDULE_FULL_YIELD 65536
+
+// Weight of the last run in the yield of a rule: 1 / 2^SCHEDULE_DECAY
+#define SCHEDULE_DECAY 4
+
+// Yield under which a rule is skipped: about one run in 32 finds something
+#define SCHEDULE_MIN_YIELD (SCHEDULE_FULL_YIELD / 32)
+
+// Turns a rule of low yield is skipped between two runs
+#define SCHEDULE_SKIP 15
+
+// Online yield of a rule
+typedef struct {
+    uint64_t runs;      // Times the rule ran
+    uint64_t hits;      // Runs that filled a cell or found a conflict
+    uint64_t skips;     // Times the rule was skipped
+    int yield;          // Moving average of the runs that found something (SCHEDULE_FULL_YIELD: all)
+    int skip;           // Times the rule is still skipped before it runs again
+} t_rule_yield;
+
+// Propagation scheduler: cheap rules run to a fixpoint before the next tier, and a
+// rule that seldom finds anything is only run now and then
+typedef struct {
+    tier_t max_tier;            // Most expensive tier run (TIER_BASIC to TIER_PROBE)
+    t_probe_limits probe;       // Limits of the probing tier
+    const t_kernels* kernels;   // Basic rules of the current call (the generic ones: the rules of grid.c one by one)
+    int mark;                   // Trail length at which the current call started stable (-1: unknown)
+    t_rule_yield yield[SCHEDULE_RULES];
+} t_schedule;
+
+// Scheduler functions
+void schedule_init(t_schedule* schedule, tier_t max_tier, const t_probe_limits* probe);
+rule_result_t schedule_propagate(t_schedule* schedule, t_grid* g, const t_kernels* kernels, int mark);
+void schedule_print(const t_schedule* schedule, FILE* fd);
+bool parse_propagation(const char* name, tier_t* tier);
+
+#endif // SCHEDULE_H
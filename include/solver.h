@@ -0,0 +1,109 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "../include/grid.h"
+#include "../include/ttable.h"
+#include "../include/symmetry.h"
+#include "../include/kernels.h"
+#include "../include/schedule.h"
+
+// Result of a run of the solver
+typedef enum {
+    SOLVER_SOLUTION,    // A solution is in the grid, the next run looks for the next one
+    SOLVER_EXHAUSTED,   // The search tree is fully explored
+    SOLVER_NODE_LIMIT,  // Paused: the node budget is spent
+    SOLVER_TIMEOUT,     // Paused: the time limit is reached
+    SOLVER_CANCELLED,   // Paused: the cancellation flag is set
+    SOLVER_PAUSED       // Paused: the pause interval elapsed, the search can be saved and resumed
+} solver_status_t;
+
+// Outcome of a solve, complete or stopped by its budget
+typedef struct {
+    solver_status_t status; // SOLVER_NODE_LIMIT, SOLVER_TIMEOUT or SOLVER_CANCELLED if the search stopped early
+    uint64_t solutions;     // Solutions found (a lower bound if the search stopped early)
+    uint64_t nodes;         // Nodes propagated
+    long elapsed_ms;        // Time of the solve in milliseconds
+    bool saved;             // The search was saved to the checkpoint file of the options when it ended
+} t_solve_stats;
+
+// Decision of the search, one per level of the explicit stack
+typedef struct {
+    int cell;       // Index of the decision cell (row * cols + column)
+    int mark;       // Trail length before the decision
+    char value;     // Value tried, '0' then '1'
+    bool open;      // The other value still has to be tried
+    bool partial;   // Part of the subtree was given to another solver, its count is not stored
+    uint64_t hash;  // Transposition key of the propagated state before the decision
+    uint64_t check; // Second hash of that state, verified by the transposition table
+    uint64_t base;  // Solutions counted before the decision
+    uint32_t resolved;  // Symmetries whose image is known to be larger than the grid, one bit each
+} t_frame;
+
+// Iterative depth-first search over a grid
+typedef struct {
+    t_grid* grid;           // Grid searched in place, with a trail
+    t_frame* stack;         // Decision stack, one frame per level
+    int depth;              // Number of frames on the stack
+    bool backtrack;         // The current node is closed (conflict or reported solution)
+    bool finished;          // The search tree is fully explored
+    uint64_t nodes;         // Nodes propagated so far
+    uint64_t solutions;     // Solutions found so far
+    uint64_t max_nodes;     // Node budget of the search (0: no limit)
+    long deadline;          // Time when the search stops, on the clock of solver_now_ms (0: no limit)
+    const atomic_bool* cancel;  // Stops the search once set (NULL: never)
+    long pause_ms;          // Interval between two pauses of a run in milliseconds (0: no pause)
+    long pause_at;          // Time of the next pause, on the clock of solver_now_ms
+    t_ttable* table;        // Memoized subtree counts (NULL: plain enumeration)
+    int empty_cells;        // Empty cells of the grid when the search started
+    const t_symmetry* symmetry; // Symmetries of the clues: only canonical solutions are searched (NULL: all)
+    const t_kernels* kernels;   // Consistency check and propagation for the size of the grid
+    t_schedule schedule;        // Propagation rules of each node, with their yields
+    t_rng* rng;                 // Draws the value tried first at each decision (NULL: '0' first)
+} t_solver;
+
+// Lazy enumeration of the solutions of a grid, suspended between two solutions
+typedef struct {
+    t_solver solver;        // Search over the grid, paused on the current solution
+    t_symmetry symmetry;    // Symmetries of the clues
+    t_grid image;           // Solution handed out
+    char* orbit;            // Distinct images of the current solution handed out so far, cells row by row
+    int transform;          // Next transform applied to the current solution (symmetry.size: none left)
+    int distinct;           // Number of images in orbit
+    uint64_t handed;        // Solutions handed out so far
+    bool exhausted;         // The search tree is fully explored
+    solver_status_t status; // Result of the last run of the search
+} t_solution_iter;
+
+// Solver functions
+void solver_init(t_solver* solver, t_grid* grid);
+void solver_free(t_solver* solver);
+void solver_set_limits(t_solver* solver, uint64_t max_nodes, long timeout_ms);
+void solver_set_cancel(t_solver* solver, const atomic_bool* cancel);
+void solver_set_pause(t_solver* solver, long interval_ms);
+void solver_set_table(t_solver* solver, t_ttable* table);
+void solver_set_symmetry(t_solver* solver, const t_symmetry* symmetry);
+void solver_set_propagation(t_solver* solver, tier_t max_tier, int depth, long budget);
+void solver_set_random(t_solver* solver, t_rng* rng);
+solver_status_t solver_run(t_solver* solver);
+bool solver_stopped(solver_status_t status);
+bool solver_split(t_solver* donor, t_solver* receiver);
+
+// Called with each solution of an enumeration and its number from 1; returns false to stop it
+typedef bool (*solution_callback_t)(const t_grid* solution, uint64_t index, void* data);
+
+// Solving functions, with the propagation and the budget of the options (stats may be NULL)
+bool solve_first(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats);
+uint64_t solve_all(t_grid* grid, const takuzu_Options* options, solution_callback_t callback, void* data, t_solve_stats* stats);
+uint64_t solve_count(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats);
+void solution_iter_init(t_solution_iter* iter, t_grid* grid, const takuzu_Options* options);
+const t_grid* solution_iter_next(t_solution_iter* iter);
+void solution_iter_free(t_solution_iter* iter);
+
+// Solving functions of the command line, printing their results
+void print_stopped(const t_solve_stats* stats);
+void find_first_solution(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats);
+void find_all_solutions(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats);
+void count_all_solutions(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats);
+void grid_solver(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats);
+
+#endif // SOLVER_H
@@ -0,0 +1,20 @@
+#ifndef SWAR8_H
+#define SWAR8_H
+
+#include "../include/grid.h"
+
+// Whole 8x8 grid in two words: cell (i, j) is bit 8 * i + j, row i is byte i
+typedef struct {
+    uint64_t filled;    // Cells holding a value
+    uint64_t ones;      // Cells holding '1'
+} t_board8;
+
+// 8x8 engine functions
+t_board8 swar8_load(const t_grid* g);
+uint64_t swar8_transpose(uint64_t x);
+bool swar8_board_consistent(t_board8 board);
+t_board8 swar8_board_propagate(t_board8 board);
+bool swar8_consistent(t_grid* g);
+bool swar8_propagate(t_grid* g);
+
+#endif // SWAR8_H
@@ -0,0 +1,36 @@
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include "../include/grid.h"
+
+// Rotations and reflections of a square grid, each with or without swapping '0' and '1'
+#define SYMMETRY_MAX 16
+
+// Rotation or reflection of a grid, possibly swapping '0' and '1'
+typedef struct {
+    int* source;        // Cell of the grid moved to each cell of the image
+    bool complement;    // '0' and '1' are swapped
+} t_transform;
+
+// Transforms that leave the clues of a grid unchanged, the identity first
+typedef struct {
+    t_transform transforms[SYMMETRY_MAX];
+    int size;           // Number of transforms, the order of the group
+} t_symmetry;
+
+// Result of the comparison of a partial grid with one of its images
+typedef enum {
+    SYMMETRY_SMALLER,   // The grid is lexicographically smaller than its image
+    SYMMETRY_EQUAL,     // The grid is equal to its image on every cell
+    SYMMETRY_UNKNOWN,   // An empty cell is met before the grid and its image differ
+    SYMMETRY_LARGER     // The grid is larger than its image: it is not canonical
+} symmetry_order_t;
+
+// Symmetry functions
+void symmetry_detect(const t_grid* grid, t_symmetry* symmetry);
+void symmetry_free(t_symmetry* symmetry);
+symmetry_order_t symmetry_compare(const t_grid* grid, const t_transform* transform);
+void symmetry_apply(const t_grid* grid, const t_transform* transform, t_grid* image);
+int symmetry_orbit_size(const t_grid* grid, const t_symmetry* symmetry);
+
+#endif // SYMMETRY_H
@@ -4,24 +4,59 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <getopt.h>
 #include <string.h> 
 #include <time.h>
 #include <limits.h>
 #include <math.h>
+#include <stdatomic.h>
 
-#define MAX_GRID_SIZE 5000 //A grid have a max size of 64
+#include "../include/lineset.h"
+#include "../include/log.h"
+
+#define MAX_GRID_SIZE 4096 // Largest number of rows/columns accepted
+
+struct t_checkpoint;    // Saved search (checkpoint.h)
 
 typedef struct {
-    int size;
-    char* grid;
+    int rows;
+    int cols;
+    char* grid;             // Cells '0', '1' or '_', row by row
+    char* columns;          // The same cells column by column: cell (i, j) at j * rows + i
+    int row_words;          // 64-bit words per packed row (1 up to 64 columns)
+    int col_words;          // 64-bit words per packed column (1 up to 64 rows)
+    uint64_t* row_filled;   // Packed rows: cells holding a value
+    uint64_t* row_ones;     // Packed rows: cells holding '1'
+    uint64_t* col_filled;   // Packed columns: cells holding a value
+    uint64_t* col_ones;     // Packed columns: cells holding '1'
+    t_lineset full_rows;    // Complete rows, to find identical rows without comparing them
+    t_lineset full_cols;    // Complete columns
+    int empty;              // Empty cells of the grid
+    int* row_empty;         // Empty cells per row
+    int* col_empty;         // Empty cells per column
+    int* trail;             // Cells filled since the trail was started, in order (NULL if not recorded)
+    int trail_length;       // Number of cells on the trail
 } t_grid;
 
+// Number of 64-bit words of the packed rows and columns of a grid
+#define GRID_BIT_WORDS(g) (2 * (size_t)(g)->rows * (g)->row_words + 2 * (size_t)(g)->cols * (g)->col_words)
+
 typedef enum {
     MODE_FIRST,
-    MODE_ALL
+    MODE_ALL,
+    MODE_COUNT,     // Count all solutions without printing them
+    MODE_COUNT_DP   // Count all solutions with the transfer matrix
 } mode_t;
 
+// Propagation tiers, from the cheapest to the most expensive
+typedef enum {
+    TIER_BASIC,     // Rules of grid.c (triples, middle pattern, balance)
+    TIER_LINES,     // Exact line completion and distinct lines
+    TIER_PROBE,     // Failed-literal probing
+    TIER_BRANCH     // Branching is required
+} tier_t;
+
 typedef struct {
     bool verbose;
     bool unique;
@@ -29,30 +64,65 @@ typedef struct {
     bool all;
     bool generate_mode;
     int number;
-    int grid_size;
+    int grid_rows;
+    int grid_cols;
     mode_t mode;
+    int count;          // Number of grids to generate
+    int jobs;           // Number of generation threads
+    uint64_t seed;      // Seed of the random streams
+    bool seed_given;
+    bool rate;          // Rate the difficulty of the input grid
+    tier_t difficulty;  // Target difficulty of the generated grids
+    bool difficulty_given;
+    bool batch;         // The input holds several grids separated by blank lines
+    int probe_depth;    // Nesting of the failed-literal probes of the solver (0: no probing)
+    long probe_budget;  // Values the solver probes per node and per round (0: no limit)
+    tier_t propagation; // Most expensive propagation tier of the solver
+    bool propagation_given;
+    uint64_t max_nodes; // Nodes each solve may propagate (0: no limit)
+    long timeout_ms;    // Time each solve may take, in milliseconds (0: no limit)
+    atomic_bool* cancel;    // Set from another thread or a signal handler to stop the solves (NULL: none)
+    char* checkpoint_file;  // The search of -a or -A is saved there periodically and when it stops (NULL: never)
+    char* resume_file;      // Checkpoint file the search resumes from (NULL: a new search)
+    const struct t_checkpoint* resume;  // Checkpoint read from resume_file, for the solve of the grid
 } takuzu_Options;
 
-// External declaration of the 'option' variable
-extern takuzu_Options option;
+// Streaming reader of grids, one line at a time
+typedef struct {
+    FILE* file;
+    char* line;         // Line buffer, grown by getline
+    size_t capacity;    // Size of the line buffer
+    int line_number;    // Number of lines read so far
+    bool multiple;      // A blank line ends a grid, so the stream can hold several grids
+    char error[128];    // Why the last grid read is malformed, empty otherwise
+} t_grid_reader;
 
 // Function to initialize Takuzu options
 void initializeTakuzuOptions(takuzu_Options* options);
 
 void output_to_file(const char* filename, const char* content);
 
-// Function to allocate memory for the grid
-void grid_allocate(t_grid* g, int size);
+// Function to check if a number of rows or columns is valid (even, from 2 to MAX_GRID_SIZE)
+bool is_valid_grid_size(int size);
+
+// Function to allocate memory for a grid of rows x cols
+void grid_allocate(t_grid* g, int rows, int cols);
 
 // Function to free memory allocated for the grid
 void grid_free(t_grid* g);
 
 // Function to print the grid to a file
-void grid_print(t_grid* g, FILE* fd);
+void grid_print(const t_grid* g, FILE* fd);
 
 // Function to check if a character is valid for the Takuzu grid
 bool check_char(const char c);
 
+// Functions to read grids from a stream, one grid after the other
+bool grid_reader_open(t_grid_reader* reader, const char* filename, bool multiple);
+void grid_reader_attach(t_grid_reader* reader, FILE* file, bool multiple);
+int grid_read(t_grid_reader* reader, t_grid* grid);
+void grid_reader_close(t_grid_reader* reader);
+
 // Function to parse a File to Takuzu grid
 int file_parser(t_grid* grid, const char* filename);
 
@@ -0,0 +1,40 @@
+#ifndef TTABLE_H
+#define TTABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Default memory of a transposition table, in megabytes
+#define TT_DEFAULT_MB 64
+
+// Entries per bucket: a key can only be stored in the bucket its hash selects
+#define TT_BUCKET_SIZE 4
+
+// Memoized solution count of a propagated grid state. The state is known by two
+// independent 64-bit hashes: the key selects the bucket, and both must match on a
+// probe, so a wrong count needs a 128-bit collision
+typedef struct {
+    uint64_t key;       // Zobrist hash of the state (0: empty entry)
+    uint64_t check;     // Second hash of the state, from another mixer
+    uint64_t count;     // Number of solutions below the state
+    uint32_t depth;     // Empty cells of the state, the size of the subtree it saves
+    uint32_t age;       // Store counter when the entry was written
+} t_tt_entry;
+
+// Transposition table of bounded memory
+typedef struct {
+    t_tt_entry* entries;
+    size_t buckets;     // Number of buckets (a power of two)
+    uint32_t age;       // Number of stores so far
+    uint64_t hits;      // Successful probes
+    uint64_t stores;    // Entries written
+} t_ttable;
+
+// Transposition table functions
+void tt_init(t_ttable* table, size_t megabytes);
+void tt_free(t_ttable* table);
+bool tt_probe(t_ttable* table, uint64_t key, uint64_t check, uint64_t* count);
+void tt_store(t_ttable* table, uint64_t key, uint64_t check, uint64_t count, int depth);
+
+#endif // TTABLE_H
@@ -0,0 +1,363 @@
+#include "../include/avx64.h"
+
+
+/*
+ * A 64x64 grid is 64 packed rows of one word each, 16 AVX2 registers per mask. The
+ * rules then run on four rows per instruction:
+ * - in rows, a cell and its neighbours are one bit apart in the same 64-bit lane,
+ *   and the bits shifted out of a lane are simply lost;
+ * - in columns, a cell and its neighbours are in the rows above and below, loaded
+ *   one or two words further in arrays padded with empty rows;
+ * - the counts of the rows are the popcounts of the lanes, and the counts of the
+ *   columns the same on the packed columns, refreshed by a 64x64 bit transpose.
+ * Machines without AVX2 keep the scalar kernels of kernels.c.
+ */
+
+#if AVX64_ENABLED
+
+#include <immintrin.h>
+
+// Functions using AVX2, only called once avx64_supported returned true
+#define AVX64_TARGET __attribute__((target("avx2,popcnt")))
+
+// Number of lines of the grid, and of vectors of four lines
+#define AVX64_LINES 64
+#define AVX64_VECTORS 16
+
+// Empty rows before and after the rows in the padded arrays
+#define AVX64_PAD 2
+
+// Cells filled by a round above which the columns are transposed again rather than
+// updated cell by cell
+#define AVX64_TRANSPOSE_CELLS 256
+
+
+/*
+ * Tells whether the processor runs AVX2 instructions.
+ *
+ * Returns:
+ * true if the AVX2 engine can be used, false otherwise.
+ */
+bool avx64_supported(void) {
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+}
+
+
+static inline AVX64_TARGET __m256i avx64_load(const uint64_t* words) {
+    return _mm256_loadu_si256((const __m256i*)words);
+}
+
+
+static inline AVX64_TARGET void avx64_store(uint64_t* words, __m256i x) {
+    _mm256_storeu_si256((__m256i*)words, x);
+}
+
+
+/*
+ * Counts the bits of every 64-bit lane: the bits of each nibble are looked up in a
+ * table, and the counts of the bytes summed per lane.
+ */
+static inline AVX64_TARGET __m256i avx64_popcount(__m256i x) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(x, nibble));
+    __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble));
+    return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+
+/*
+ * Gives the cells of four lines forced to the opposite value by the cells holding
+ * a value: next to a pair of them, or between two of them.
+ */
+static inline AVX64_TARGET __m256i avx64_forced(__m256i v) {
+    __m256i pairs = _mm256_and_si256(v, _mm256_srli_epi64(v, 1));
+    __m256i around = _mm256_and_si256(_mm256_slli_epi64(v, 1), _mm256_srli_epi64(v, 1));
+    return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi64(pairs, 2), _mm256_srli_epi64(pairs, 1)), around);
+}
+
+
+/*
+ * Swaps the blocks of four words a[k..k+3] and a[k+j..k+j+3] holding a block of
+ * the transpose, j being a multiple of 4.
+ */
+static inline AVX64_TARGET void avx64_swap_rows(uint64_t* a, int k, int j, __m256i mask) {
+    __m256i top = avx64_load(a + k);
+    __m256i bottom = avx64_load(a + k + j);
+    __m256i t = _mm256_and_si256(_mm256_xor_si256(_mm256_srli_epi64(top, j), bottom), mask);
+    avx64_store(a + k, _mm256_xor_si256(top, _mm256_slli_epi64(t, j)));
+    avx64_store(a + k + j, _mm256_xor_si256(bottom, t));
+}
+
+
+/*
+ * Transposes a 64x64 bit matrix in place: bit j of word i moves to bit i of word j.
+ * Six rounds swap the off-diagonal blocks of 32, 16, 8, 4, 2 and 1 bits; the last
+ * two rounds pair words of the same vector and swap them with a permutation.
+ *
+ * Parameters:
+ * - a: The 64 words of the matrix.
+ */
+static AVX64_TARGET void avx64_transpose(uint64_t* a) {
+    static const uint64_t masks[6] = {
+        0x00000000FFFFFFFFULL, 0x0000FFFF0000FFFFULL, 0x00FF00FF00FF00FFULL,
+        0x0F0F0F0F0F0F0F0FULL, 0x3333333333333333ULL, 0x5555555555555555ULL
+    };
+    for (int round = 0, j = 32; j >= 4; round++, j >>= 1) {
+        __m256i mask = _mm256_set1_epi64x(masks[round]);
+        for (int k = 0; k < AVX64_LINES; k += 4) {
+            if ((k & j) == 0) {
+                avx64_swap_rows(a, k, j, mask);
+            }
+        }
+    }
+
+    const __m256i mask2 = _mm256_set1_epi64x(masks[4]);
+    const __m256i mask1 = _mm256_set1_epi64x(masks[5]);
+    const __m256i zero = _mm256_setzero_si256();
+    for (int k = 0; k < AVX64_LINES; k += 4) {
+        // Words k, k + 1 with k + 2, k + 3: the halves of the vector
+        __m256i v = avx64_load(a + k);
+        __m256i swapped = _mm256_permute4x64_epi64(v, 0x4E);
+        __m256i t = _mm256_and_si256(_mm256_xor_si256(_mm256_srli_epi64(v, 2), swapped), mask2);
+        t = _mm256_blend_epi32(t, zero, 0xF0);
+        v = _mm256_xor_si256(v, _mm256_xor_si256(_mm256_slli_epi64(t, 2), _mm256_permute4x64_epi64(t, 0x4E)));
+
+        // Words k with k + 1 and k + 2 with k + 3: the neighbouring lanes
+        swapped = _mm256_permute4x64_epi64(v, 0xB1);
+        t = _mm256_and_si256(_mm256_xor_si256(_mm256_srli_epi64(v, 1), swapped), mask1);
+        t = _mm256_blend_epi32(t, zero, 0xCC);
+        v = _mm256_xor_si256(v, _mm256_xor_si256(_mm256_slli_epi64(t, 1), _mm256_permute4x64_epi64(t, 0xB1)));
+        avx64_store(a + k, v);
+    }
+}
+
+
+/*
+ * Finds the lines holding 32 values of a kind, half of their cells.
+ *
+ * Parameters:
+ * - filled: The 64 words of the cells holding a value.
+ * - ones: The 64 words of the cells holding '1'.
+ * - zeros_half: Receives the lines holding 32 '0', bit i for line i.
+ * - ones_half: Receives the lines holding 32 '1', bit i for line i.
+ */
+static AVX64_TARGET void avx64_half_lines(const uint64_t* filled, const uint64_t* ones, uint64_t* zeros_half, uint64_t* ones_half) {
+    const __m256i half = _mm256_set1_epi64x(AVX64_LINES / 2);
+    *zeros_half = 0;
+    *ones_half = 0;
+    for (int v = 0; v < AVX64_VECTORS; v++) {
+        __m256i f = avx64_load(filled + 4 * v);
+        __m256i o = avx64_load(ones + 4 * v);
+        __m256i z = _mm256_andnot_si256(o, f);
+        __m256i zeros_eq = _mm256_cmpeq_epi64(avx64_popcount(z), half);
+        __m256i ones_eq = _mm256_cmpeq_epi64(avx64_popcount(o), half);
+        *zeros_half |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(zeros_eq)) << (4 * v);
+        *ones_half |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(ones_eq)) << (4 * v);
+    }
+}
+
+
+/*
+ * Checks the consistency of a 64x64 grid, with the same checks as is_consistent.
+ * The rows and the columns are both packed, so the triples and the counts of each
+ * are found within the lanes, and the sets of complete lines tell whether two
+ * of them are identical.
+ *
+ * Parameters:
+ * - g: Pointer to a 64x64 grid.
+ *
+ * Returns:
+ * true if the grid is consistent, false otherwise.
+ */
+AVX64_TARGET bool avx64_consistent(t_grid* g) {
+    if (grid_has_identical_lines(g)) {
+        return false;
+    }
+
+    const __m256i half = _mm256_set1_epi64x(AVX64_LINES / 2);
+    for (int pass = 0; pass < 2; pass++) {
+        const uint64_t* filled = (pass == 0) ? g->row_filled : g->col_filled;
+        const uint64_t* ones = (pass == 0) ? g->row_ones : g->col_ones;
+        __m256i broken = _mm256_setzero_si256();
+        for (int v = 0; v < AVX64_VECTORS; v++) {
+            __m256i f = avx64_load(filled + 4 * v);
+            __m256i o = avx64_load(ones + 4 * v);
+            __m256i z = _mm256_andnot_si256(o, f);
+            __m256i zero_triples = _mm256_and_si256(_mm256_and_si256(z, _mm256_srli_epi64(z, 1)), _mm256_srli_epi64(z, 2));
+            __m256i one_triples = _mm256_and_si256(_mm256_and_si256(o, _mm256_srli_epi64(o, 1)), _mm256_srli_epi64(o, 2));
+            broken = _mm256_or_si256(broken, _mm256_or_si256(zero_triples, one_triples));
+            broken = _mm256_or_si256(broken, _mm256_cmpgt_epi64(avx64_popcount(z), half));
+            broken = _mm256_or_si256(broken, _mm256_cmpgt_epi64(avx64_popcount(o), half));
+        }
+        if (!_mm256_testz_si256(broken, broken)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*
+ * Applies the basic rules to a 64x64 grid until none fills a cell, then writes the
+ * filled cells back into the grid, its packed lines, its counts of empty cells, its
+ * sets of complete lines and its trail. The rows are updated in place, four at a time, so a row sees the cells just filled in the rows
+ * above it. The packed columns are updated after each round, cell by cell when the
+ * round filled a few cells and by transposing the rows otherwise, and are ahead of
+ * the packed rows until the end. A cell forced to both values gets '1', which
+ * breaks the rule that forced '0' and is caught by the consistency check.
+ *
+ * Parameters:
+ * - g: Pointer to a 64x64 grid.
+ *
+ * Returns:
+ * true if a cell was filled, false otherwise.
+ */
+AVX64_TARGET bool avx64_propagate(t_grid* g) {
+    const __m256i half = _mm256_set1_epi64x(AVX64_LINES / 2);
+    const __m256i full = _mm256_set1_epi64x(-1);
+    // Rows of zeros and of ones, between empty rows
+    uint64_t zeros[AVX64_LINES + 2 * AVX64_PAD];
+    uint64_t ones[AVX64_LINES + 2 * AVX64_PAD];
+    uint64_t added[AVX64_LINES];
+    for (int k = 0; k < AVX64_PAD; k++) {
+        zeros[k] = ones[k] = 0;
+        zeros[AVX64_PAD + AVX64_LINES + k] = ones[AVX64_PAD + AVX64_LINES + k] = 0;
+    }
+    for (int v = 0; v < AVX64_VECTORS; v++) {
+        __m256i f = avx64_load(g->row_filled + 4 * v);
+        __m256i o = avx64_load(g->row_ones + 4 * v);
+        avx64_store(zeros + AVX64_PAD + 4 * v, _mm256_andnot_si256(o, f));
+        avx64_store(ones + AVX64_PAD + 4 * v, o);
+    }
+    uint64_t full_columns = 0;
+    for (int j = 0; j < AVX64_LINES; j++) {
+        full_columns |= (uint64_t)(g->col_filled[j] == ~0ULL) << j;
+    }
+
+    bool changed = false;
+    for (;;) {
+        // Columns holding half of their cells of one value, on the packed columns
+        uint64_t col_zeros_half, col_ones_half;
+        avx64_half_lines(g->col_filled, g->col_ones, &col_zeros_half, &col_ones_half);
+        __m256i col_zeros_full = _mm256_set1_epi64x((long long)col_zeros_half);
+        __m256i col_ones_full = _mm256_set1_epi64x((long long)col_ones_half);
+
+        __m256i any = _mm256_setzero_si256();
+        for (int row = AVX64_PAD; row < AVX64_PAD + AVX64_LINES; row += 4) {
+            __m256i z = avx64_load(zeros + row);
+            __m256i o = avx64_load(ones + row);
+            __m256i f = _mm256_or_si256(z, o);
+            if (_mm256_testc_si256(f, full)) {
+                avx64_store(added + row - AVX64_PAD, _mm256_setzero_si256());
+                continue;
+            }
+
+            // Rows, then columns: pairs above or below, and the rows around
+            __m256i above = avx64_load(zeros + row - 1);
+            __m256i below = avx64_load(zeros + row + 1);
+            __m256i set_one = avx64_forced(z);
+            set_one = _mm256_or_si256(set_one, _mm256_and_si256(avx64_load(zeros + row - 2), above));
+            set_one = _mm256_or_si256(set_one, _mm256_and_si256(avx64_load(zeros + row + 2), below));
+            set_one = _mm256_or_si256(set_one, _mm256_and_si256(above, below));
+            above = avx64_load(ones + row - 1);
+            below = avx64_load(ones + row + 1);
+            __m256i set_zero = avx64_forced(o);
+            set_zero = _mm256_or_si256(set_zero, _mm256_and_si256(avx64_load(ones + row - 2), above));
+            set_zero = _mm256_or_si256(set_zero, _mm256_and_si256(avx64_load(ones + row + 2), below));
+            set_zero = _mm256_or_si256(set_zero, _mm256_and_si256(above, below));
+
+            // Lines holding 32 values of a kind get the other value everywhere else
+            set_one = _mm256_or_si256(set_one, _mm256_cmpeq_epi64(avx64_popcount(z), half));
+            set_zero = _mm256_or_si256(set_zero, _mm256_cmpeq_epi64(avx64_popcount(o), half));
+            set_one = _mm256_or_si256(set_one, col_zeros_full);
+            set_zero = _mm256_or_si256(set_zero, col_ones_full);
+
+            set_one = _mm256_andnot_si256(f, set_one);
+            set_zero = _mm256_andnot_si256(_mm256_or_si256(f, set_one), set_zero);
+            __m256i set = _mm256_or_si256(set_one, set_zero);
+            any = _mm256_or_si256(any, set);
+            avx64_store(added + row - AVX64_PAD, set);
+            avx64_store(zeros + row, _mm256_or_si256(z, set_zero));
+            avx64_store(ones + row, _mm256_or_si256(o, set_one));
+        }
+        if (_mm256_testz_si256(any, any)) {
+            break;
+        }
+        changed = true;
+
+        int cells = 0;
+        for (int i = 0; i < AVX64_LINES; i++) {
+            cells += __builtin_popcountll(added[i]);
+        }
+        if (cells > AVX64_TRANSPOSE_CELLS) {
+            for (int i = 0; i < AVX64_LINES; i++) {
+                g->col_filled[i] = zeros[AVX64_PAD + i] | ones[AVX64_PAD + i];
+                g->col_ones[i] = ones[AVX64_PAD + i];
+            }
+            avx64_transpose(g->col_filled);
+            avx64_transpose(g->col_ones);
+            continue;
+        }
+        for (int i = 0; i < AVX64_LINES; i++) {
+            for (uint64_t bits = added[i]; bits != 0; bits &= bits - 1) {
+                int j = __builtin_ctzll(bits);
+                g->col_filled[j] |= 1ULL << i;
+                g->col_ones[j] |= ((ones[AVX64_PAD + i] >> j) & 1) << i;
+            }
+        }
+    }
+    if (!changed) {
+        return false;
+    }
+
+    for (int i = 0; i < AVX64_LINES; i++) {
+        uint64_t row_ones = ones[AVX64_PAD + i];
+        uint64_t row_filled = zeros[AVX64_PAD + i] | row_ones;
+        uint64_t added = row_filled & ~g->row_filled[i];
+        while (added != 0) {
+            int cell = i * AVX64_LINES + __builtin_ctzll(added);
+            if (g->trail != NULL) {
+                g->trail[g->trail_length++] = cell;
+            }
+            grid_write_cell(g, i, cell % AVX64_LINES, ((row_ones >> (cell % AVX64_LINES)) & 1) ? '1' : '0');
+            g->empty--;
+            g->row_empty[i]--;
+            g->col_empty[cell % AVX64_LINES]--;
+            added &= added - 1;
+        }
+        bool completed = (row_filled == ~0ULL && g->row_filled[i] != ~0ULL);
+        g->row_filled[i] = row_filled;
+        g->row_ones[i] = row_ones;
+        if (completed) {
+            lineset_insert(&g->full_rows, g->row_ones, 1, i);
+        }
+    }
+    for (int j = 0; j < AVX64_LINES; j++) {
+        if (g->col_filled[j] == ~0ULL && !((full_columns >> j) & 1)) {
+            lineset_insert(&g->full_cols, g->col_ones, 1, j);
+        }
+    }
+    return true;
+}
+
+#else
+
+// Without AVX2 the engine is never selected, and these only keep the linker happy
+
+bool avx64_supported(void) {
+    return false;
+}
+
+
+bool avx64_consistent(t_grid* g) {
+    return is_consistent(g);
+}
+
+
+bool avx64_propagate(t_grid* g) {
+    return apply_heuristics_once(g);
+}
+
+#endif // AVX64_ENABLED
@@ -0,0 +1,177 @@
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "../include/batch.h"
+#include "../include/grid.h"
+#include "../include/rating.h"
+
+
+// Shared state of a batch generation
+typedef struct {
+    const takuzu_Options* options;
+    FILE* fd;
+    atomic_int next_index;      // Next puzzle index to generate
+    atomic_int failures;        // Number of grids that could not be generated
+    int next_output;            // Next puzzle index to write, protected by lock
+    bool truncated;             // A grid was cancelled: the later ones are not written, protected by lock
+    bool written;               // A grid was written, so the next one needs a separator, protected by lock
+    pthread_mutex_t lock;
+    pthread_cond_t turn;
+} t_batch;
+
+
+/*
+ * Generates one grid with the settings of the options: a puzzle of the target difficulty,
+ * a grid with a solution (unique), or a random fill of options->number percent of the cells.
+ *
+ * Parameters:
+ * - grid: Pointer to an allocated grid of the requested size.
+ * - options: Generation options (number, unique, difficulty, cancel).
+ * - rng: Random generator owned by the caller (one per thread).
+ *
+ * Returns:
+ * true if the grid was generated, false if the requested cells could not be filled or
+ * the generation was cancelled.
+ */
+bool generate_grid(t_grid* grid, const takuzu_Options* options, t_rng* rng) {
+    if (options->difficulty_given) {
+        return generate_grid_with_difficulty(grid, options->difficulty, options->cancel, rng);
+    }
+    if (options->unique) {
+        return generate_random_grid_with_solution(grid, options->number, options->cancel, rng);
+    }
+    return generate_random_grid(grid, options->number, options->cancel, rng);
+}
+
+
+/*
+ * Worker thread of a batch generation.
+ * Each worker owns its grid and its random generator. Before each puzzle the generator
+ * is reseeded with the stream (seed, puzzle index), so the batch content only depends
+ * on --seed and not on the number of threads or on scheduling.
+ * Puzzles are claimed in increasing order and written in that same order: a worker
+ * waits for its turn before printing, which keeps at most one puzzle per thread in flight.
+ * Once options->cancel is set, no puzzle is claimed, and the output stops before the
+ * first puzzle whose generation was cancelled, so it is a prefix of the whole batch.
+ *
+ * Parameters:
+ * - arg: Pointer to the shared t_batch.
+ *
+ * Returns:
+ * NULL.
+ */
+static void* batch_worker(void* arg) {
+    t_batch* batch = (t_batch*)arg;
+    const takuzu_Options* options = batch->options;
+    log_verbose = options->verbose;
+
+    t_rng rng;
+    t_grid grid;
+    grid_allocate(&grid, options->grid_rows, options->grid_cols);
+
+    while (1) {
+        // A cancelled batch stops claiming grids
+        if (options->cancel != NULL && atomic_load(options->cancel)) {
+            break;
+        }
+        int index = atomic_fetch_add(&batch->next_index, 1);
+        if (index >= options->count) {
+            break;
+        }
+
+        rng_seed(&rng, options->seed, (uint64_t)index);
+        bool generated = generate_grid(&grid, options, &rng);
+        bool cancelled = !generated && options->cancel != NULL && atomic_load(options->cancel);
+        if (!generated && !cancelled) {
+            // A failed grid is not written, the error names its index instead
+            fprintf(stderr, "Error: Unable to fill %d%% of grid %d.\n", options->number, index);
+            atomic_fetch_add(&batch->failures, 1);
+        }
+
+        // Wait for our turn, then stream the grid (grids are separated by a blank line)
+        pthread_mutex_lock(&batch->lock);
+        while (batch->next_output != index) {
+            pthread_cond_wait(&batch->turn, &batch->lock);
+        }
+        batch->truncated = batch->truncated || cancelled;
+        if (!batch->truncated && generated) {
+            if (batch->written) {
+                fprintf(batch->fd, "\n");
+            }
+            grid_print(&grid, batch->fd);
+            batch->written = true;
+        }
+        batch->next_output++;
+        pthread_cond_broadcast(&batch->turn);
+        pthread_mutex_unlock(&batch->lock);
+    }
+
+    grid_free(&grid);
+    return NULL;
+}
+
+
+/*
+ * Generates options->count grids of options->grid_rows x options->grid_cols cells on options->jobs threads
+ * and streams them to the given file, in puzzle order.
+ *
+ * Parameters:
+ * - options: Generation options (size, percentage, unique, count, jobs, seed).
+ * - fd: File stream where the grids are written.
+ *
+ * Returns:
+ * EXIT_SUCCESS if every grid was generated, EXIT_FAILURE otherwise.
+ */
+int generate_batch(const takuzu_Options* options, FILE* fd) {
+    if (options == NULL || fd == NULL) {
+        fprintf(stderr, "Error: Invalid arguments in generate_batch.\n");
+        return EXIT_FAILURE;
+    }
+
+    int jobs = options->jobs;
+    if (jobs > options->count) {
+        jobs = options->count;
+    }
+    if (jobs < 1) {
+        return EXIT_SUCCESS;
+    }
+
+    t_batch batch;
+    batch.options = options;
+    batch.fd = fd;
+    atomic_init(&batch.next_index, 0);
+    atomic_init(&batch.failures, 0);
+    batch.next_output = 0;
+    batch.truncated = false;
+    batch.written = false;
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.turn, NULL);
+
+    pthread_t threads[MAX_JOBS];
+    int started = 0;
+    int status = EXIT_SUCCESS;
+    for (int i = 0; i < jobs; i++) {
+        if (pthread_create(&threads[i], NULL, batch_worker, &batch) != 0) {
+            fprintf(stderr, "Error: Unable to start generation thread %d.\n", i);
+            status = EXIT_FAILURE;
+            break;
+        }
+        started++;
+    }
+
+    // With at least one worker the batch still completes, only slower
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    if (started == 0) {
+        status = EXIT_FAILURE;
+    }
+    else if (atomic_load(&batch.failures) > 0) {
+        status = EXIT_FAILURE;
+    }
+
+    pthread_cond_destroy(&batch.turn);
+    pthread_mutex_destroy(&batch.lock);
+    fflush(fd);
+    return status;
+}
@@ -0,0 +1,399 @@
+#include <dirent.h>
+#include <unistd.h>
+
+#include "../include/checkpoint.h"
+
+
+/*
+ * A checkpoint file is text, one field per line after a header:
+ *
+ *   takuzu-checkpoint 3
+ *   mode all                       (or count)
+ *   size ROWS COLS
+ *   propagation TIER DEPTH BUDGET
+ *   nodes N
+ *   solutions N
+ *   handed N
+ *   flags BACKTRACK FINISHED
+ *   cells CELLS                    (rows x cols '0', '1' and '_', row by row)
+ *   first CELLS                    (or '-' before the first solution)
+ *   trail LENGTH                   then the filled cells, in order
+ *   stack DEPTH                    then one frame per line:
+ *   CELL MARK VALUE OPEN PARTIAL HASH CHECK BASE RESOLVED
+ *
+ * The clues are the cells that are not on the trail, so the file also tells which
+ * grid it belongs to.
+ */
+
+
+/*
+ * Writes the cells of a grid on one line after a keyword.
+ */
+static void checkpoint_write_cells(FILE* file, const char* keyword, const char* cells, size_t count) {
+    fprintf(file, "%s ", keyword);
+    fwrite(cells, 1, count, file);
+    fputc('\n', file);
+}
+
+
+/*
+ * Flushes the directory of a file to the disk, so that its last rename survives a
+ * crash of the machine.
+ */
+static bool checkpoint_sync_directory(const char* filename) {
+    const char* slash = strrchr(filename, '/');
+    char* directory;
+    if (slash == NULL) {
+        directory = strdup(".");
+    }
+    else {
+        size_t length = (slash == filename) ? 1 : (size_t)(slash - filename);
+        directory = strndup(filename, length);
+    }
+    if (directory == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in checkpoint_sync_directory.\n");
+        exit(EXIT_FAILURE);
+    }
+    // opendir rather than open: fcntl.h would clash with the mode_t of takuzu.h
+    DIR* dir = opendir(directory);
+    free(directory);
+    if (dir == NULL) {
+        return false;
+    }
+    bool synced = (fsync(dirfd(dir)) == 0);
+    return (closedir(dir) == 0) && synced;
+}
+
+
+/*
+ * Saves a paused or finished search to a checkpoint file. The file is written next to
+ * its final name, synced and renamed, then the rename is synced, so an interruption
+ * never leaves a partial checkpoint.
+ * Output streams are flushed first, so the solutions counted as handed out are written.
+ *
+ * Parameters:
+ * - filename: Name of the checkpoint file, replaced.
+ * - solver: Pointer to a solver stopped by solver_run (not on a solution being handed out).
+ * - options: Options of the search (mode and propagation).
+ * - handed: Solutions already handed out by the enumeration (0 for a count).
+ * - first: First solution handed out, NULL if none.
+ *
+ * Returns:
+ * true if the checkpoint was written, false otherwise (the previous one is then kept).
+ */
+bool checkpoint_write(const char* filename, const t_solver* solver, const takuzu_Options* options,
+    uint64_t handed, const t_grid* first) {
+    fflush(NULL);
+
+    size_t length = strlen(filename);
+    char* temporary = (char*)malloc(length + 5);
+    if (temporary == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in checkpoint_write.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(temporary, filename, length);
+    memcpy(temporary + length, ".tmp", 5);
+
+    FILE* file = fopen(temporary, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Unable to write the checkpoint '%s'.\n", temporary);
+        free(temporary);
+        return false;
+    }
+
+    const t_grid* g = solver->grid;
+    size_t cells = (size_t)g->rows * g->cols;
+    fprintf(file, "takuzu-checkpoint %d\n", CHECKPOINT_VERSION);
+    fprintf(file, "mode %s\n", (options->mode == MODE_COUNT) ? "count" : "all");
+    fprintf(file, "size %d %d\n", g->rows, g->cols);
+    fprintf(file, "propagation %d %d %ld\n", (int)options->propagation, options->probe_depth, options->probe_budget);
+    fprintf(file, "nodes %llu\n", (unsigned long long)solver->nodes);
+    fprintf(file, "solutions %llu\n", (unsigned long long)solver->solutions);
+    fprintf(file, "handed %llu\n", (unsigned long long)handed);
+    fprintf(file, "flags %d %d\n", solver->backtrack, solver->finished);
+    checkpoint_write_cells(file, "cells", g->grid, cells);
+    if (first != NULL) {
+        checkpoint_write_cells(file, "first", first->grid, cells);
+    }
+    else {
+        fprintf(file, "first -\n");
+    }
+
+    fprintf(file, "trail %d\n", g->trail_length);
+    for (int t = 0; t < g->trail_length; t++) {
+        fprintf(file, "%d%c", g->trail[t], (t % 16 == 15 || t == g->trail_length - 1) ? '\n' : ' ');
+    }
+    fprintf(file, "stack %d\n", solver->depth);
+    for (int k = 0; k < solver->depth; k++) {
+        const t_frame* frame = &solver->stack[k];
+        fprintf(file, "%d %d %c %d %d %llx %llx %llu %lx\n", frame->cell, frame->mark, frame->value, frame->open,
+            frame->partial, (unsigned long long)frame->hash, (unsigned long long)frame->check,
+            (unsigned long long)frame->base, (unsigned long)frame->resolved);
+    }
+
+    bool written = (fflush(file) == 0 && fsync(fileno(file)) == 0);
+    written = (fclose(file) == 0) && written;
+    if (!written || rename(temporary, filename) != 0 || !checkpoint_sync_directory(filename)) {
+        fprintf(stderr, "Error: Unable to write the checkpoint '%s'.\n", filename);
+        remove(temporary);
+        written = false;
+    }
+    free(temporary);
+    return written;
+}
+
+
+/*
+ * Reads a keyword of a checkpoint file and checks that it is the expected one.
+ */
+static bool checkpoint_expect(FILE* file, const char* keyword) {
+    char word[32];
+    return fscanf(file, "%31s", word) == 1 && strcmp(word, keyword) == 0;
+}
+
+
+/*
+ * Reads count cells '0', '1' or '_' written on one line.
+ */
+static bool checkpoint_read_cells(FILE* file, char* cells, size_t count) {
+    if (fscanf(file, " ") != 0 || fread(cells, 1, count, file) != count) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (cells[i] != '0' && cells[i] != '1' && cells[i] != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*
+ * Reads the fields of a checkpoint file, after its header.
+ */
+static bool checkpoint_parse(FILE* file, t_checkpoint* checkpoint) {
+    char mode[16];
+    int propagation;
+    unsigned long long nodes, solutions, handed;
+    int backtrack, finished;
+    if (!checkpoint_expect(file, "mode") || fscanf(file, "%15s", mode) != 1 ||
+        !checkpoint_expect(file, "size") || fscanf(file, "%d %d", &checkpoint->rows, &checkpoint->cols) != 2 ||
+        !checkpoint_expect(file, "propagation") ||
+        fscanf(file, "%d %d %ld", &propagation, &checkpoint->probe_depth, &checkpoint->probe_budget) != 3 ||
+        !checkpoint_expect(file, "nodes") || fscanf(file, "%llu", &nodes) != 1 ||
+        !checkpoint_expect(file, "solutions") || fscanf(file, "%llu", &solutions) != 1 ||
+        !checkpoint_expect(file, "handed") || fscanf(file, "%llu", &handed) != 1 ||
+        !checkpoint_expect(file, "flags") || fscanf(file, "%d %d", &backtrack, &finished) != 2) {
+        return false;
+    }
+    if (strcmp(mode, "all") != 0 && strcmp(mode, "count") != 0) {
+        return false;
+    }
+    if (!is_valid_grid_size(checkpoint->rows) || !is_valid_grid_size(checkpoint->cols) ||
+        propagation < TIER_BASIC || propagation > TIER_PROBE) {
+        return false;
+    }
+    checkpoint->mode = (strcmp(mode, "count") == 0) ? MODE_COUNT : MODE_ALL;
+    checkpoint->propagation = (tier_t)propagation;
+    checkpoint->nodes = nodes;
+    checkpoint->solutions = solutions;
+    checkpoint->handed = handed;
+    checkpoint->backtrack = (backtrack != 0);
+    checkpoint->finished = (finished != 0);
+
+    int cells = checkpoint->rows * checkpoint->cols;
+    checkpoint->cells = (char*)malloc(cells);
+    checkpoint->trail = (int*)malloc((size_t)cells * sizeof(int));
+    checkpoint->stack = (t_frame*)malloc((size_t)cells * sizeof(t_frame));
+    if (checkpoint->cells == NULL || checkpoint->trail == NULL || checkpoint->stack == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in checkpoint_read.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (!checkpoint_expect(file, "cells") || !checkpoint_read_cells(file, checkpoint->cells, cells) ||
+        !checkpoint_expect(file, "first")) {
+        return false;
+    }
+    char marker[2];
+    if (fscanf(file, " %1[-]", marker) != 1) {
+        checkpoint->first = (char*)malloc(cells);
+        if (checkpoint->first == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed in checkpoint_read.\n");
+            exit(EXIT_FAILURE);
+        }
+        if (!checkpoint_read_cells(file, checkpoint->first, cells)) {
+            return false;
+        }
+    }
+
+    // The trail holds distinct filled cells, and each decision sits on the trail at its mark
+    if (!checkpoint_expect(file, "trail") || fscanf(file, "%d", &checkpoint->trail_length) != 1 ||
+        checkpoint->trail_length < 0 || checkpoint->trail_length > cells) {
+        return false;
+    }
+    bool* filled = (bool*)calloc(cells, sizeof(bool));
+    if (filled == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in checkpoint_read.\n");
+        exit(EXIT_FAILURE);
+    }
+    bool valid = true;
+    for (int t = 0; t < checkpoint->trail_length && valid; t++) {
+        int cell;
+        valid = fscanf(file, "%d", &cell) == 1 && cell >= 0 && cell < cells && checkpoint->cells[cell] != '_' &&
+            !filled[cell];
+        if (valid) {
+            filled[cell] = true;
+            checkpoint->trail[t] = cell;
+        }
+    }
+    free(filled);
+    if (!valid) {
+        return false;
+    }
+    if (!checkpoint_expect(file, "stack") || fscanf(file, "%d", &checkpoint->depth) != 1 ||
+        checkpoint->depth < 0 || checkpoint->depth > checkpoint->trail_length) {
+        return false;
+    }
+    for (int k = 0; k < checkpoint->depth; k++) {
+        t_frame* frame = &checkpoint->stack[k];
+        int open, partial;
+        unsigned long long hash, check, base;
+        unsigned long resolved;
+        if (fscanf(file, "%d %d %c %d %d %llx %llx %llu %lx", &frame->cell, &frame->mark, &frame->value, &open,
+            &partial, &hash, &check, &base, &resolved) != 9) {
+            return false;
+        }
+        if (frame->mark < 0 || frame->mark >= checkpoint->trail_length ||
+            (k > 0 && frame->mark <= checkpoint->stack[k - 1].mark) ||
+            checkpoint->trail[frame->mark] != frame->cell || checkpoint->cells[frame->cell] != frame->value) {
+            return false;
+        }
+        frame->open = (open != 0);
+        frame->partial = (partial != 0);
+        frame->hash = hash;
+        frame->check = check;
+        frame->base = base;
+        frame->resolved = (uint32_t)resolved;
+    }
+    return true;
+}
+
+
+/*
+ * Reads a checkpoint file written by checkpoint_write.
+ *
+ * Parameters:
+ * - filename: Name of the checkpoint file.
+ * - checkpoint: Receives the saved search, to free with checkpoint_free.
+ *
+ * Returns:
+ * true if the file holds a valid checkpoint, false otherwise (with a message).
+ */
+bool checkpoint_read(const char* filename, t_checkpoint* checkpoint) {
+    checkpoint->cells = NULL;
+    checkpoint->first = NULL;
+    checkpoint->trail = NULL;
+    checkpoint->stack = NULL;
+
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Unable to open the checkpoint '%s'.\n", filename);
+        return false;
+    }
+    int version;
+    bool valid = checkpoint_expect(file, "takuzu-checkpoint") && fscanf(file, "%d", &version) == 1 &&
+        version == CHECKPOINT_VERSION && checkpoint_parse(file, checkpoint);
+    fclose(file);
+    if (!valid) {
+        fprintf(stderr, "Error: '%s' is not a valid checkpoint.\n", filename);
+        checkpoint_free(checkpoint);
+    }
+    return valid;
+}
+
+
+/*
+ * Checks that a checkpoint saved the search of a grid with the given options: same
+ * clues, same mode and same propagation, as the search tree depends on them.
+ *
+ * Parameters:
+ * - checkpoint: Pointer to the saved search.
+ * - grid: Pointer to the grid to solve.
+ * - options: Options of the search.
+ *
+ * Returns:
+ * true if the search can be resumed, false otherwise (with a message).
+ */
+bool checkpoint_matches(const t_checkpoint* checkpoint, const t_grid* grid, const takuzu_Options* options) {
+    if (checkpoint->rows != grid->rows || checkpoint->cols != grid->cols) {
+        fprintf(stderr, "Error: The checkpoint is for a grid of another size.\n");
+        return false;
+    }
+    if (checkpoint->mode != options->mode) {
+        fprintf(stderr, "Error: The checkpoint is for the mode %s.\n", (checkpoint->mode == MODE_COUNT) ? "-A" : "-a");
+        return false;
+    }
+    if (checkpoint->propagation != options->propagation || checkpoint->probe_depth != options->probe_depth ||
+        checkpoint->probe_budget != options->probe_budget) {
+        fprintf(stderr, "Error: The checkpoint was written with another propagation (-L, -p, -P).\n");
+        return false;
+    }
+
+    int cells = grid->rows * grid->cols;
+    char* clues = (char*)malloc(cells);
+    if (clues == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in checkpoint_matches.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(clues, checkpoint->cells, cells);
+    for (int t = 0; t < checkpoint->trail_length; t++) {
+        clues[checkpoint->trail[t]] = '_';
+    }
+    bool same = memcmp(clues, grid->grid, cells) == 0;
+    free(clues);
+    if (!same) {
+        fprintf(stderr, "Error: The checkpoint is for another grid.\n");
+    }
+    return same;
+}
+
+
+/*
+ * Puts a solver back in the state of a checkpoint: the cells of the trail are filled
+ * again in order, then the decision stack and the counters are restored. The next
+ * solver_run continues the search from the node where it was saved.
+ *
+ * Parameters:
+ * - checkpoint: Pointer to a saved search that matches the grid (see checkpoint_matches).
+ * - solver: Pointer to a solver initialized on the grid and not run yet.
+ */
+void checkpoint_restore(const t_checkpoint* checkpoint, t_solver* solver) {
+    t_grid* g = solver->grid;
+    for (int t = 0; t < checkpoint->trail_length; t++) {
+        int cell = checkpoint->trail[t];
+        grid_fill_cell(g, cell / g->cols, cell % g->cols, checkpoint->cells[cell]);
+    }
+    memcpy(solver->stack, checkpoint->stack, (size_t)checkpoint->depth * sizeof(t_frame));
+    solver->depth = checkpoint->depth;
+    solver->backtrack = checkpoint->backtrack;
+    solver->finished = checkpoint->finished;
+    solver->nodes = checkpoint->nodes;
+    solver->solutions = checkpoint->solutions;
+}
+
+
+/*
+ * Frees the arrays of a checkpoint.
+ *
+ * Parameters:
+ * - checkpoint: Pointer to the checkpoint.
+ */
+void checkpoint_free(t_checkpoint* checkpoint) {
+    free(checkpoint->cells);
+    free(checkpoint->first);
+    free(checkpoint->trail);
+    free(checkpoint->stack);
+    checkpoint->cells = NULL;
+    checkpoint->first = NULL;
+    checkpoint->trail = NULL;
+    checkpoint->stack = NULL;
+}
@@ -0,0 +1,799 @@
+#include "../include/dpcount.h"
+#include "../include/solver.h"
+
+
+/*
+ * The transfer matrix places the grid one row at a time. A state is what the rows
+ * still to place can see of the rows already placed:
+ * - the number of '0' of each column, which gives its remaining balance,
+ * - which columns are still identical, as a partition of the columns,
+ * - the last two rows, for the triples of the columns,
+ * - the rows already used that a later row could still repeat.
+ * Two partial grids with the same state have the same completions, so a state only
+ * carries the number of partial grids reaching it. Rows are distinct because a row
+ * is never placed twice, and columns because every class of the partition must be
+ * a single column once the grid is full.
+ *
+ * The key of a state is an array of 64-bit words: the column counts and the labels
+ * of the partition packed as bytes, then the last two rows, then the sorted set
+ * of used rows.
+ *
+ * The set of used rows is what makes the number of states grow, so the counter
+ * keeps it small in two ways. It places the grid along the side whose lines have
+ * the fewest candidates: a 6x10 grid is placed column by column, as 10 lines of 6
+ * cells. And when the clues are unchanged by mirroring the columns or by swapping
+ * '0' and '1', a state and its images have the same completions, so they are
+ * merged into the smallest of their keys.
+ */
+
+// Maps of a row that keep the order of the rows, so that they map states onto states
+enum {
+    DP_MIRROR,              // Columns in reverse order
+    DP_COMPLEMENT,          // '0' and '1' swapped
+    DP_MIRROR_COMPLEMENT,   // Both
+    DP_SYMMETRY_COUNT
+};
+
+// State of the transfer matrix in a table
+typedef struct {
+    uint64_t hash;      // Hash of the key (slot empty if length is 0)
+    size_t offset;      // Position of the key in the key array of the table
+    uint32_t length;    // Number of words of the key
+    dp_count_t count;   // Number of partial grids reaching the state
+} t_dp_slot;
+
+// States of one row of the transfer matrix, in an open addressing hash table
+typedef struct {
+    t_dp_slot* slots;
+    size_t capacity;        // Number of slots (a power of two)
+    size_t size;            // Number of states
+    uint64_t* keys;         // Keys of the states, one after the other
+    size_t keys_length;
+    size_t keys_capacity;
+} t_dp_table;
+
+// Transfer matrix of one grid
+typedef struct {
+    int rows;
+    int cols;
+    uint64_t full;          // Mask of the columns
+    uint64_t** candidates;  // Rows allowed by the clues, for each row of the grid
+    int* lengths;           // Number of candidates of each row of the grid
+    uint64_t* clue_filled;  // Cells holding a clue, for each row of the grid
+    uint64_t* clue_ones;    // Clues holding '1', for each row of the grid
+    int header_words;       // Words of the column counts and partition labels in a key
+    bool symmetries[DP_SYMMETRY_COUNT]; // Maps of the columns and values that leave the clues unchanged
+} t_dp;
+
+
+/*
+ * Mixes a word into a running hash.
+ *
+ * Parameters:
+ * - hash: Hash of the previous words.
+ * - word: Word to mix.
+ *
+ * Returns:
+ * The new hash.
+ */
+static uint64_t dp_hash_word(uint64_t hash, uint64_t word) {
+    hash ^= word + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    hash ^= hash >> 31;
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    return hash ^ (hash >> 29);
+}
+
+
+/*
+ * Initializes an empty state table.
+ *
+ * Parameters:
+ * - table: Pointer to the table.
+ */
+static void dp_table_init(t_dp_table* table) {
+    table->capacity = 1024;
+    table->size = 0;
+    table->slots = (t_dp_slot*)calloc(table->capacity, sizeof(t_dp_slot));
+    table->keys_capacity = 4096;
+    table->keys_length = 0;
+    table->keys = (uint64_t*)malloc(table->keys_capacity * sizeof(uint64_t));
+    if (table->slots == NULL || table->keys == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in dp_table_init.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+/*
+ * Frees the states of a table.
+ *
+ * Parameters:
+ * - table: Pointer to the table.
+ */
+static void dp_table_free(t_dp_table* table) {
+    free(table->slots);
+    free(table->keys);
+    table->slots = NULL;
+    table->keys = NULL;
+    table->capacity = 0;
+    table->size = 0;
+}
+
+
+/*
+ * Doubles the number of slots of a table. The keys do not move.
+ *
+ * Parameters:
+ * - table: Pointer to the table.
+ */
+static void dp_table_grow(t_dp_table* table) {
+    size_t capacity = table->capacity * 2;
+    t_dp_slot* slots = (t_dp_slot*)calloc(capacity, sizeof(t_dp_slot));
+    if (slots == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in dp_table_grow.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i].length == 0) {
+            continue;
+        }
+        size_t index = table->slots[i].hash & (capacity - 1);
+        while (slots[index].length != 0) {
+            index = (index + 1) & (capacity - 1);
+        }
+        slots[index] = table->slots[i];
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+}
+
+
+/*
+ * Adds partial grids to a state, creating the state if it is new.
+ *
+ * Parameters:
+ * - table: Pointer to the table.
+ * - key: Key of the state.
+ * - length: Number of words of the key.
+ * - count: Number of partial grids reaching the state.
+ */
+static void dp_table_add(t_dp_table* table, const uint64_t* key, uint32_t length, dp_count_t count) {
+    uint64_t hash = 0;
+    for (uint32_t i = 0; i < length; i++) {
+        hash = dp_hash_word(hash, key[i]);
+    }
+
+    size_t index = hash & (table->capacity - 1);
+    while (table->slots[index].length != 0) {
+        t_dp_slot* slot = &table->slots[index];
+        if (slot->hash == hash && slot->length == length &&
+            memcmp(table->keys + slot->offset, key, length * sizeof(uint64_t)) == 0) {
+            slot->count += count;
+            return;
+        }
+        index = (index + 1) & (table->capacity - 1);
+    }
+
+    if (table->keys_length + length > table->keys_capacity) {
+        while (table->keys_length + length > table->keys_capacity) {
+            table->keys_capacity *= 2;
+        }
+        uint64_t* keys = (uint64_t*)realloc(table->keys, table->keys_capacity * sizeof(uint64_t));
+        if (keys == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed in dp_table_add.\n");
+            exit(EXIT_FAILURE);
+        }
+        table->keys = keys;
+    }
+    memcpy(table->keys + table->keys_length, key, length * sizeof(uint64_t));
+
+    t_dp_slot* slot = &table->slots[index];
+    slot->hash = hash;
+    slot->offset = table->keys_length;
+    slot->length = length;
+    slot->count = count;
+    table->keys_length += length;
+    table->size++;
+    if (table->size * 2 > table->capacity) {
+        dp_table_grow(table);
+    }
+}
+
+
+/*
+ * Applies a map of the symmetries to a row.
+ *
+ * Parameters:
+ * - dp: Pointer to the transfer matrix.
+ * - symmetry: Map of the row (DP_MIRROR, DP_COMPLEMENT or DP_MIRROR_COMPLEMENT).
+ * - row: Mask of the row.
+ *
+ * Returns:
+ * The mask of the image of the row.
+ */
+static uint64_t dp_map_row(const t_dp* dp, int symmetry, uint64_t row) {
+    if (symmetry != DP_COMPLEMENT) {
+        uint64_t mirrored = 0;
+        for (int j = 0; j < dp->cols; j++) {
+            mirrored |= ((row >> j) & 1) << (dp->cols - 1 - j);
+        }
+        row = mirrored;
+    }
+    if (symmetry != DP_MIRROR) {
+        row ^= dp->full;
+    }
+    return row;
+}
+
+
+/*
+ * Writes the image of a state key by a map of the symmetries.
+ *
+ * Parameters:
+ * - dp: Pointer to the transfer matrix.
+ * - symmetry: Map of the rows.
+ * - key: Key of the state.
+ * - length: Number of words of the key.
+ * - level: Number of rows placed in the state.
+ * - image: Output key, of length words.
+ * - relabel: Scratch array of dp->cols entries.
+ */
+static void dp_map_key(const t_dp* dp, int symmetry, const uint64_t* key, int length, int level,
+                       uint64_t* image, int* relabel) {
+    int cols = dp->cols;
+    int hw = dp->header_words;
+    const uint8_t* zeros = (const uint8_t*)key;
+    const uint8_t* labels = zeros + cols;
+    memset(image, 0, hw * sizeof(uint64_t));
+    uint8_t* image_zeros = (uint8_t*)image;
+    uint8_t* image_labels = image_zeros + cols;
+
+    bool mirror = symmetry != DP_COMPLEMENT;
+    bool complement = symmetry != DP_MIRROR;
+    int classes = 0;
+    for (int j = 0; j < cols; j++) {
+        relabel[j] = -1;
+    }
+    for (int j = 0; j < cols; j++) {
+        int source = mirror ? cols - 1 - j : j;
+        image_zeros[j] = complement ? (uint8_t)(level - zeros[source]) : zeros[source];
+        if (relabel[labels[source]] < 0) {
+            relabel[labels[source]] = classes++;
+        }
+        image_labels[j] = (uint8_t)relabel[labels[source]];
+    }
+
+    // The last two rows are only mapped once placed, the others stay 0
+    image[hw] = level >= 1 ? dp_map_row(dp, symmetry, key[hw]) : 0;
+    image[hw + 1] = level >= 2 ? dp_map_row(dp, symmetry, key[hw + 1]) : 0;
+
+    // Used rows, sorted again by insertion since the sets are small
+    for (int i = hw + 2; i < length; i++) {
+        uint64_t row = dp_map_row(dp, symmetry, key[i]);
+        int k = i;
+        while (k > hw + 2 && image[k - 1] > row) {
+            image[k] = image[k - 1];
+            k--;
+        }
+        image[k] = row;
+    }
+}
+
+
+/*
+ * Replaces a state key by the smallest key of its images by the symmetries of the
+ * clues, so that the states of an orbit are counted once.
+ *
+ * Parameters:
+ * - dp: Pointer to the transfer matrix.
+ * - key: Key of the state, replaced by the canonical key.
+ * - length: Number of words of the key.
+ * - level: Number of rows placed in the state.
+ * - scratch: Scratch keys, of 2 * length words.
+ * - relabel: Scratch array of dp->cols entries.
+ */
+static void dp_canonical_key(const t_dp* dp, uint64_t* key, int length, int level, uint64_t* scratch, int* relabel) {
+    uint64_t* image = scratch;
+    uint64_t* best = scratch + length;
+    bool mapped = false;
+    for (int symmetry = 0; symmetry < DP_SYMMETRY_COUNT; symmetry++) {
+        if (!dp->symmetries[symmetry]) {
+            continue;
+        }
+        dp_map_key(dp, symmetry, key, length, level, image, relabel);
+        const uint64_t* smallest = mapped ? best : key;
+        int i = 0;
+        while (i < length && image[i] == smallest[i]) {
+            i++;
+        }
+        if (i < length && image[i] < smallest[i]) {
+            memcpy(best, image, length * sizeof(uint64_t));
+            mapped = true;
+        }
+    }
+    if (mapped) {
+        memcpy(key, best, length * sizeof(uint64_t));
+    }
+}
+
+
+/*
+ * Enumerates the rows allowed by the clues of a row of the grid: balanced rows
+ * without three identical consecutive cells.
+ *
+ * Parameters:
+ * - dp: Pointer to the transfer matrix.
+ * - cells: Cells of the row of the grid.
+ * - col: Next column to fill.
+ * - mask: '1' cells of the columns already filled.
+ * - ones: Number of '1' so far.
+ * - out: Array receiving the rows, of DP_MAX_ROW_CANDIDATES entries.
+ * - length: Number of rows found so far, updated.
+ *
+ * Returns:
+ * false if the row has more than DP_MAX_ROW_CANDIDATES candidates, true otherwise.
+ */
+static bool dp_enumerate_rows(const t_dp* dp, const char* cells, int col, uint64_t mask, int ones,
+                              uint64_t* out, int* length) {
+    if (col == dp->cols) {
+        if (*length == DP_MAX_ROW_CANDIDATES) {
+            return false;
+        }
+        out[(*length)++] = mask;
+        return true;
+    }
+
+    for (int bit = 0; bit <= 1; bit++) {
+        if (cells[col] != '_' && cells[col] - '0' != bit) {
+            continue;
+        }
+        int count = bit ? ones + 1 : col + 1 - ones;
+        if (count > dp->cols / 2) {
+            continue;
+        }
+        if (col >= 2 && (int)((mask >> (col - 1)) & 1) == bit && (int)((mask >> (col - 2)) & 1) == bit) {
+            continue;
+        }
+        uint64_t next = bit ? mask | (1ULL << col) : mask;
+        if (!dp_enumerate_rows(dp, cells, col + 1, next, ones + bit, out, length)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*
+ * Frees the candidate rows of a transfer matrix.
+ *
+ * Parameters:
+ * - dp: Pointer to the transfer matrix.
+ */
+static void dp_free(t_dp* dp) {
+    for (int i = 0; i < dp->rows; i++) {
+        free(dp->candidates[i]);
+    }
+    free(dp->candidates);
+    free(dp->lengths);
+    free(dp->clue_filled);
+    free(dp->clue_ones);
+}
+
+
+/*
+ * Builds the candidate rows of a grid, given row by row or column by column.
+ *
+ * Parameters:
+ * - dp: Pointer to the transfer matrix to initialize.
+ * - cells: Cells of the grid, one line after the other.
+ * - rows: Number of lines to place.
+ * - cols: Number of cells of a line.
+ *
+ * Returns:
+ * false if the grid is too large or a line has too many candidates, true otherwise.
+ * Only a transfer matrix built with success must be freed.
+ */
+static bool dp_init(t_dp* dp, const char* cells, int rows, int cols) {
+    if (cols > DP_MAX_COLS || rows > DP_MAX_ROWS) {
+        return false;
+    }
+    dp->rows = rows;
+    dp->cols = cols;
+    dp->full = cols == 64 ? ~0ULL : (1ULL << cols) - 1;
+    dp->header_words = (2 * cols + 7) / 8;
+    dp->candidates = (uint64_t**)calloc(rows, sizeof(uint64_t*));
+    dp->lengths = (int*)calloc(rows, sizeof(int));
+    dp->clue_filled = (uint64_t*)calloc(rows, sizeof(uint64_t));
+    dp->clue_ones = (uint64_t*)calloc(rows, sizeof(uint64_t));
+    if (dp->candidates == NULL || dp->lengths == NULL || dp->clue_filled == NULL || dp->clue_ones == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in dp_init.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t* buffer = (uint64_t*)malloc(DP_MAX_ROW_CANDIDATES * sizeof(uint64_t));
+    if (buffer == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in dp_init.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < rows; i++) {
+        const char* line = cells + (size_t)i * cols;
+        for (int j = 0; j < cols; j++) {
+            if (line[j] != '_') {
+                dp->clue_filled[i] |= 1ULL << j;
+            }
+            if (line[j] == '1') {
+                dp->clue_ones[i] |= 1ULL << j;
+            }
+        }
+
+        int length = 0;
+        if (!dp_enumerate_rows(dp, line, 0, 0, 0, buffer, &length)) {
+            free(buffer);
+            dp_free(dp);
+            return false;
+        }
+        dp->candidates[i] = (uint64_t*)malloc((length > 0 ? length : 1) * sizeof(uint64_t));
+        if (dp->candidates[i] == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed in dp_init.\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(dp->candidates[i], buffer, length * sizeof(uint64_t));
+        dp->lengths[i] = length;
+    }
+    free(buffer);
+
+    // A map is a symmetry when it sends the clues of every row onto themselves
+    for (int symmetry = 0; symmetry < DP_SYMMETRY_COUNT; symmetry++) {
+        bool mirror = symmetry != DP_COMPLEMENT;
+        bool complement = symmetry != DP_MIRROR;
+        dp->symmetries[symmetry] = true;
+        for (int i = 0; i < rows && dp->symmetries[symmetry]; i++) {
+            uint64_t filled = dp->clue_filled[i];
+            uint64_t ones = dp->clue_ones[i];
+            if (mirror) {
+                filled = dp_map_row(dp, DP_MIRROR, filled);
+                ones = dp_map_row(dp, DP_MIRROR, ones);
+            }
+            if (complement) {
+                ones ^= filled;
+            }
+            dp->symmetries[symmetry] = filled == dp->clue_filled[i] && ones == dp->clue_ones[i];
+        }
+    }
+    return true;
+}
+
+
+/*
+ * Gives the total number of candidate rows of a transfer matrix, which bounds the
+ * sets of used rows of its states.
+ *
+ * Parameters:
+ * - dp: Pointer to the transfer matrix.
+ *
+ * Returns:
+ * The sum of the candidates of every row.
+ */
+static size_t dp_total_candidates(const t_dp* dp) {
+    size_t total = 0;
+    for (int i = 0; i < dp->rows; i++) {
+        total += (size_t)dp->lengths[i];
+    }
+    return total;
+}
+
+
+/*
+ * Tells whether a row can still be placed below a given row of the grid: it fits
+ * the remaining balance of the columns and the clues of one of the rows left.
+ *
+ * Parameters:
+ * - dp: Pointer to the transfer matrix.
+ * - row: Mask of the row.
+ * - level: Number of rows placed.
+ * - full_zeros: Columns holding all their '0'.
+ * - full_ones: Columns holding all their '1'.
+ *
+ * Returns:
+ * true if some later row can be equal to the row, false otherwise.
+ */
+static bool dp_row_reusable(const t_dp* dp, uint64_t row, int level, uint64_t full_zeros, uint64_t full_ones) {
+    if ((~row & full_zeros) != 0 || (row & full_ones) != 0) {
+        return false;
+    }
+    for (int i = level; i < dp->rows; i++) {
+        if ((row & dp->clue_filled[i]) == dp->clue_ones[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/*
+ * Counts the solutions of a grid with the transfer matrix. The number of states
+ * grows with the shorter side of the grid and the number of empty lines, so this
+ * counter is meant for narrow or nearly empty grids whose search tree is too large
+ * to walk: an empty 8x8 or 6x10 grid takes well under a second, while an empty 8x12
+ * or 10x10 grid goes past DP_MAX_STATES and needs clues.
+ *
+ * Parameters:
+ * - grid: Pointer to the grid, left unchanged.
+ * - cancel: Flag that stops the count once set, read every DP_POLL_INTERVAL slots (NULL: none).
+ * - count: Output number of solutions.
+ *
+ * Returns:
+ * false if the grid is too large for the transfer matrix or the count was cancelled,
+ * true otherwise.
+ */
+bool dp_count_solutions(const t_grid* grid, const atomic_bool* cancel, dp_count_t* count) {
+    // The grid and its transpose have the same solutions, place the one with fewer candidates
+    t_dp dp;
+    t_dp transposed;
+    bool by_rows = dp_init(&dp, grid->grid, grid->rows, grid->cols);
+    bool by_cols = dp_init(&transposed, grid->columns, grid->cols, grid->rows);
+    if (by_cols && (!by_rows || dp_total_candidates(&transposed) < dp_total_candidates(&dp))) {
+        if (by_rows) {
+            dp_free(&dp);
+        }
+        dp = transposed;
+        LOG_INFO("Transfer matrix: placing the grid column by column.\n");
+    }
+    else if (by_cols) {
+        dp_free(&transposed);
+    }
+    else if (!by_rows) {
+        return false;
+    }
+
+    int cols = dp.cols;
+    int half = dp.rows / 2;
+    int hw = dp.header_words;
+    uint64_t* key = (uint64_t*)calloc(hw + 2 + dp.rows, sizeof(uint64_t));
+    uint64_t* scratch = (uint64_t*)calloc(2 * (hw + 2 + dp.rows), sizeof(uint64_t));
+    uint8_t* header = (uint8_t*)calloc(hw, sizeof(uint64_t));
+    uint8_t* next_header = (uint8_t*)calloc(hw, sizeof(uint64_t));
+    int* relabel = (int*)malloc(2 * cols * sizeof(int));
+    int* class_size = (int*)malloc(cols * sizeof(int));
+    if (key == NULL || scratch == NULL || header == NULL || next_header == NULL || relabel == NULL ||
+        class_size == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in dp_count_solutions.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Binomial coefficients, saturated, to bound the completions of a column
+    uint64_t binomial[65][65];
+    for (int n = 0; n <= 64; n++) {
+        binomial[n][0] = 1;
+        for (int k = 1; k <= n; k++) {
+            uint64_t sum = binomial[n - 1][k - 1] + (k < n ? binomial[n - 1][k] : 0);
+            binomial[n][k] = sum < binomial[n - 1][k - 1] ? UINT64_MAX : sum;
+        }
+        for (int k = n + 1; k <= 64; k++) {
+            binomial[n][k] = 0;
+        }
+    }
+
+    // Before the first row, every column is empty and all columns are identical
+    t_dp_table current;
+    dp_table_init(&current);
+    dp_table_add(&current, key, hw + 2, 1);
+
+    dp_count_t total = 0;
+    bool complete = true;
+    for (int level = 0; level < dp.rows && current.size > 0; level++) {
+        t_dp_table next;
+        dp_table_init(&next);
+        int left = dp.rows - level - 1;
+
+        for (size_t s = 0; s < current.capacity && complete; s++) {
+            if (cancel != NULL && s % DP_POLL_INTERVAL == 0 && atomic_load_explicit(cancel, memory_order_relaxed)) {
+                complete = false;
+                break;
+            }
+            const t_dp_slot* slot = &current.slots[s];
+            if (slot->length == 0) {
+                continue;
+            }
+            const uint64_t* state = current.keys + slot->offset;
+            memcpy(header, state, hw * sizeof(uint64_t));
+            const uint8_t* zeros = header;
+            const uint8_t* labels = header + cols;
+            uint64_t last = state[hw];
+            uint64_t prev = state[hw + 1];
+            const uint64_t* used = state + hw + 2;
+            int used_length = (int)slot->length - hw - 2;
+
+            uint64_t full_zeros = 0;
+            uint64_t full_ones = 0;
+            for (int j = 0; j < cols; j++) {
+                if (zeros[j] == half) {
+                    full_zeros |= 1ULL << j;
+                }
+                if (level - zeros[j] == half) {
+                    full_ones |= 1ULL << j;
+                }
+            }
+            uint64_t same = level >= 2 ? ~(last ^ prev) & dp.full : 0;
+
+            for (int c = 0; c < dp.lengths[level]; c++) {
+                uint64_t row = dp.candidates[level][c];
+                if ((~row & full_zeros) != 0 || (row & full_ones) != 0) {
+                    continue;
+                }
+                if (((row ^ last) & same) != same) {
+                    continue;
+                }
+                bool repeated = false;
+                for (int u = 0; u < used_length && !repeated; u++) {
+                    repeated = used[u] == row;
+                }
+                if (repeated) {
+                    continue;
+                }
+
+                // Column counts and refined partition below the new row
+                uint8_t* next_zeros = next_header;
+                uint8_t* next_labels = next_header + cols;
+                int classes = 0;
+                for (int j = 0; j < 2 * cols; j++) {
+                    relabel[j] = -1;
+                }
+                for (int j = 0; j < cols; j++) {
+                    int bit = (int)((row >> j) & 1);
+                    next_zeros[j] = zeros[j] + (bit ? 0 : 1);
+                    int pair = 2 * labels[j] + bit;
+                    if (relabel[pair] < 0) {
+                        class_size[classes] = 0;
+                        relabel[pair] = classes++;
+                    }
+                    next_labels[j] = (uint8_t)relabel[pair];
+                    class_size[relabel[pair]]++;
+                }
+
+                if (left == 0) {
+                    if (classes == cols) {
+                        total += slot->count;
+                    }
+                    continue;
+                }
+
+                // Identical columns need as many distinct completions
+                bool feasible = true;
+                if (left <= 64) {
+                    for (int j = 0; j < cols && feasible; j++) {
+                        int missing = half - next_zeros[j];
+                        feasible = missing <= left &&
+                            (uint64_t)class_size[next_labels[j]] <= binomial[left][missing];
+                    }
+                }
+                if (!feasible) {
+                    continue;
+                }
+
+                uint64_t next_full_zeros = 0;
+                uint64_t next_full_ones = 0;
+                for (int j = 0; j < cols; j++) {
+                    if (next_zeros[j] == half) {
+                        next_full_zeros |= 1ULL << j;
+                    }
+                    if (level + 1 - next_zeros[j] == half) {
+                        next_full_ones |= 1ULL << j;
+                    }
+                }
+
+                // Used rows that a later row could repeat, sorted, the new row included
+                memcpy(key, next_header, hw * sizeof(uint64_t));
+                key[hw] = row;
+                key[hw + 1] = last;
+                int length = hw + 2;
+                int u = 0;
+                bool inserted = false;
+                while (u < used_length || !inserted) {
+                    uint64_t value;
+                    if (!inserted && (u == used_length || row < used[u])) {
+                        value = row;
+                        inserted = true;
+                    }
+                    else {
+                        value = used[u++];
+                    }
+                    if (dp_row_reusable(&dp, value, level + 1, next_full_zeros, next_full_ones)) {
+                        key[length++] = value;
+                    }
+                }
+                dp_canonical_key(&dp, key, length, level + 1, scratch, relabel);
+                dp_table_add(&next, key, (uint32_t)length, slot->count);
+                if (next.size > DP_MAX_STATES) {
+                    complete = false;
+                    break;
+                }
+            }
+        }
+
+        if (complete) {
+            LOG_INFO("Transfer matrix: row %d, %zu states\n", level + 1, next.size);
+        }
+        dp_table_free(&current);
+        current = next;
+        if (!complete) {
+            break;
+        }
+    }
+
+    dp_table_free(&current);
+    free(key);
+    free(scratch);
+    free(header);
+    free(next_header);
+    free(relabel);
+    free(class_size);
+    dp_free(&dp);
+
+    if (!complete) {
+        return false;
+    }
+    *count = total;
+    return true;
+}
+
+
+/*
+ * Writes a solution count in decimal.
+ *
+ * Parameters:
+ * - count: Count to write.
+ * - buffer: Output string.
+ * - size: Size of the output string, at least 40 for every count.
+ */
+void dp_count_format(dp_count_t count, char* buffer, size_t size) {
+    char digits[40];
+    int length = 0;
+    do {
+        digits[length++] = (char)('0' + (int)(count % 10));
+        count /= 10;
+    } while (count > 0);
+
+    size_t i = 0;
+    while (length > 0 && i + 1 < size) {
+        buffer[i++] = digits[--length];
+    }
+    buffer[i] = '\0';
+}
+
+
+/*
+ * Counts the solutions of a grid with the transfer matrix, and falls back to the
+ * search with a transposition table when the grid is too large for it. The transfer
+ * matrix is bounded by DP_MAX_STATES, so only the cancellation flag of the options
+ * stops it; the fallback search has the whole budget. The fallback is announced on
+ * stderr, since on an empty 10x10 grid or larger the search does not finish unless
+ * a budget stops it.
+ *
+ * Parameters:
+ * - grid: Pointer to the Takuzu grid, left unchanged.
+ * - options: Options of the command line, for the search.
+ * - stats: Receives the outcome of the count (see grid_solver).
+ */
+void count_solutions_dp(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats) {
+    dp_count_t count;
+    if (!dp_count_solutions(grid, options->cancel, &count)) {
+        // A cancelled count goes through the search too, which stops at once and prints it
+        if (options->cancel == NULL || !atomic_load(options->cancel)) {
+            fprintf(stderr, "Warning: The grid is too large for the transfer matrix, counting by search "
+                    "(--max-nodes or --timeout-ms bound it).\n");
+        }
+        count_all_solutions(grid, options, stats);
+        return;
+    }
+
+    char buffer[40];
+    dp_count_format(count, buffer, sizeof(buffer));
+    printf("Number of solutions: %s\n", buffer);
+    stats->status = SOLVER_EXHAUSTED;
+    stats->solutions = (count > UINT64_MAX) ? UINT64_MAX : (uint64_t)count;
+    stats->nodes = 0;
+    stats->elapsed_ms = 0;
+    stats->saved = false;
+}
@@ -1,4 +1,44 @@
 #include "../include/grid.h"
+#include "../include/solver.h"
+
+
+/*
+ * Rebuilds the sets of complete rows and columns from the packed lines.
+ *
+ * Parameters:
+ * - g: Pointer to the grid.
+ */
+static void grid_sync_lines(t_grid* g) {
+    lineset_clear(&g->full_rows);
+    lineset_clear(&g->full_cols);
+    for (int i = 0; i < g->rows; i++) {
+        if (g->row_empty[i] == 0) {
+            lineset_insert(&g->full_rows, g->row_ones, g->row_words, i);
+        }
+    }
+    for (int j = 0; j < g->cols; j++) {
+        if (g->col_empty[j] == 0) {
+            lineset_insert(&g->full_cols, g->col_ones, g->col_words, j);
+        }
+    }
+}
+
+
+/*
+ * Sets the counts of empty cells of a grid whose cells are all empty.
+ *
+ * Parameters:
+ * - g: Pointer to the grid.
+ */
+static void grid_reset_counts(t_grid* g) {
+    for (int i = 0; i < g->rows; i++) {
+        g->row_empty[i] = g->cols;
+    }
+    for (int j = 0; j < g->cols; j++) {
+        g->col_empty[j] = g->rows;
+    }
+    g->empty = g->rows * g->cols;
+}
 
 
 /*
@@ -18,28 +58,84 @@ void grid_copy(const t_grid* source_grid, t_grid* destination_grid) {
     }
 
     // Check if the grid sizes match
-    if (source_grid->size != destination_grid->size) {
+    if (source_grid->rows != destination_grid->rows || source_grid->cols != destination_grid->cols) {
         fprintf(stderr, "Error: Grid sizes do not match.\n");
         exit(EXIT_FAILURE);
     }
 
     // Allocate memory for the destination grid if necessary
     if (destination_grid->grid == NULL) {
-        destination_grid->grid = (char*)calloc(destination_grid->size * destination_grid->size, sizeof(char));
-        if (destination_grid->grid == NULL) {
-            fprintf(stderr, "Error: Allocation failure for destination grid.\n");
-            exit(EXIT_FAILURE);
-        }
+        grid_allocate(destination_grid, source_grid->rows, source_grid->cols);
     }
 
-    // Copy the data from the source grid to the destination grid
-    memcpy(destination_grid->grid, source_grid->grid, destination_grid->size * destination_grid->size);
+    // Copy the data from the source grid to the destination grid, packed lines and columns included
+    memcpy(destination_grid->grid, source_grid->grid, destination_grid->rows * destination_grid->cols);
+    memcpy(destination_grid->columns, source_grid->columns, destination_grid->rows * destination_grid->cols);
+    memcpy(destination_grid->row_filled, source_grid->row_filled, GRID_BIT_WORDS(destination_grid) * sizeof(uint64_t));
+    memcpy(destination_grid->row_empty, source_grid->row_empty, ((size_t)destination_grid->rows + destination_grid->cols) * sizeof(int));
+    destination_grid->empty = source_grid->empty;
+    grid_sync_lines(destination_grid);
+}
+
+
+/*
+ * Writes a cell value into the packed rows and columns of the grid and into the counts
+ * of empty cells. A complete row or column leaves its line set before it changes, and
+ * enters it again once complete.
+ *
+ * Parameters:
+ * - i: Row index of the cell.
+ * - j: Column index of the cell.
+ * - g: Pointer to the grid.
+ * - v: '0', '1' or '_'.
+ */
+void grid_set_bits(int i, int j, t_grid* g, char v) {
+    uint64_t row_bit = 1ULL << (j % 64);
+    uint64_t col_bit = 1ULL << (i % 64);
+    int row_word = i * g->row_words + j / 64;
+    int col_word = j * g->col_words + i / 64;
+    int change = ((g->row_filled[row_word] & row_bit) != 0) - (v != '_');
+
+    if (g->row_empty[i] == 0) {
+        lineset_remove(&g->full_rows, g->row_ones, g->row_words, i);
+    }
+    if (g->col_empty[j] == 0) {
+        lineset_remove(&g->full_cols, g->col_ones, g->col_words, j);
+    }
+    g->empty += change;
+    g->row_empty[i] += change;
+    g->col_empty[j] += change;
+
+    if (v == '_') {
+        g->row_filled[row_word] &= ~row_bit;
+        g->col_filled[col_word] &= ~col_bit;
+    }
+    else {
+        g->row_filled[row_word] |= row_bit;
+        g->col_filled[col_word] |= col_bit;
+    }
+    if (v == '1') {
+        g->row_ones[row_word] |= row_bit;
+        g->col_ones[col_word] |= col_bit;
+    }
+    else {
+        g->row_ones[row_word] &= ~row_bit;
+        g->col_ones[col_word] &= ~col_bit;
+    }
+
+    if (g->row_empty[i] == 0) {
+        lineset_insert(&g->full_rows, g->row_ones, g->row_words, i);
+    }
+    if (g->col_empty[j] == 0) {
+        lineset_insert(&g->full_cols, g->col_ones, g->col_words, j);
+    }
 }
 
 
 /*
  * Sets the value of the cell at coordinates (i, j) in the grid to the specified value.
- * Performs boundary checks and validation of the character value.
+ * Performs boundary checks and validation of the character value; the engine, which
+ * keeps its coordinates inside the grid, calls grid_fill_cell instead.
  *
  * Parameters:
  * - i: Row index of the cell.
@@ -49,30 +145,133 @@ void grid_copy(const t_grid* source_grid, t_grid* destination_grid) {
  */
 void set_cell(int i, int j, t_grid* g, char v) {
     // Check if coordinates are within bounds
-    if (i < 0 || i >= g->size || j < 0 || j >= g->size) {
-        if (option.verbose) {
-            fprintf(stderr, "Warning: Coordinates (%d, %d) are out of bounds for the grid. (Function: set_cell)\n", i, j);
-        }
+    if (i < 0 || i >= g->rows || j < 0 || j >= g->cols) {
+        LOG_INFO("Warning: Coordinates (%d, %d) are out of bounds for the grid. (Function: set_cell)\n", i, j);
         return;
     }
 
     // Check if the character value is valid
     if (v != '0' && v != '1') {
-        if (option.verbose) {
-            fprintf(stderr, "Warning: Invalid character '%c'. Only '0' and '1' are allowed. (Function: set_cell)\n", v);
-        }
+        LOG_INFO("Warning: Invalid character '%c'. Only '0' and '1' are allowed. (Function: set_cell)\n", v);
         return;
     }
+    grid_fill_cell(g, i, j, v);
+}
+
+
+/*
+ * Empties the cell at coordinates (i, j) in the grid.
+ *
+ * Parameters:
+ * - i: Row index of the cell.
+ * - j: Column index of the cell.
+ * - g: Pointer to the grid.
+ */
+void grid_clear_cell(int i, int j, t_grid* g) {
+    if (i < 0 || i >= g->rows || j < 0 || j >= g->cols) {
+        LOG_INFO("Warning: Coordinates (%d, %d) are out of bounds for the grid. (Function: grid_clear_cell)\n", i, j);
+        return;
+    }
+    grid_write_cell(g, i, j, '_');
+    grid_set_bits(i, j, g, '_');
+}
+
+
+/*
+ * Empties every cell of the grid.
+ *
+ * Parameters:
+ * - g: Pointer to the grid.
+ */
+void grid_reset(t_grid* g) {
+    memset(g->grid, '_', g->rows * g->cols);
+    memset(g->columns, '_', g->rows * g->cols);
+    memset(g->row_filled, 0, GRID_BIT_WORDS(g) * sizeof(uint64_t));
+    lineset_clear(&g->full_rows);
+    lineset_clear(&g->full_cols);
+    grid_reset_counts(g);
+    g->trail_length = 0;
+}
 
-    // Calculate the index corresponding to the (i, j) coordinates
-    int index = i * g->size + j;
-    g->grid[index] = v;
+
+/*
+ * Starts recording on a trail every cell that set_cell fills, so that a search can
+ * return to an earlier state with grid_undo instead of copying the grid.
+ *
+ * Parameters:
+ * - g: Pointer to the grid.
+ */
+void grid_trail_start(t_grid* g) {
+    if (g->trail == NULL) {
+        // Each cell is filled at most once between two undos, so the trail never outgrows the grid
+        g->trail = (int*)malloc((size_t)g->rows * g->cols * sizeof(int));
+        if (g->trail == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed in grid_trail_start.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    g->trail_length = 0;
+}
+
+
+/*
+ * Stops recording the filled cells and frees the trail. The cells keep their values.
+ *
+ * Parameters:
+ * - g: Pointer to the grid.
+ */
+void grid_trail_stop(t_grid* g) {
+    free(g->trail);
+    g->trail = NULL;
+    g->trail_length = 0;
+}
+
+
+/*
+ * Empties, in reverse order, the cells filled since the trail had the given length.
+ *
+ * Parameters:
+ * - g: Pointer to the grid, with a trail started.
+ * - mark: Trail length to return to.
+ */
+void grid_undo(t_grid* g, int mark) {
+    while (g->trail_length > mark) {
+        int index = g->trail[--g->trail_length];
+        grid_write_cell(g, index / g->cols, index % g->cols, '_');
+        grid_set_bits(index / g->cols, index % g->cols, g, '_');
+    }
+}
+
+
+/*
+ * Rebuilds the packed rows and columns, the sets of complete lines, the counts of empty
+ * cells and the column-major copy of the cells from the cells, after the cells were written directly (e.g., by
+ * the parser).
+ *
+ * Parameters:
+ * - g: Pointer to the grid.
+ */
+void grid_sync_bits(t_grid* g) {
+    memset(g->row_filled, 0, GRID_BIT_WORDS(g) * sizeof(uint64_t));
+    lineset_clear(&g->full_rows);
+    lineset_clear(&g->full_cols);
+    grid_reset_counts(g);
+    for (int i = 0; i < g->rows; i++) {
+        for (int j = 0; j < g->cols; j++) {
+            char v = g->grid[i * g->cols + j];
+            g->columns[j * g->rows + i] = v;
+            if (v == '0' || v == '1') {
+                grid_set_bits(i, j, g, v);
+            }
+        }
+    }
 }
 
 
 /*
  * Gets the value of the cell at coordinates (i, j) in the grid.
- * Performs boundary checks and returns an invalid character in case of an error.
+ * Performs boundary checks and returns an invalid character in case of an error; the
+ * engine calls grid_cell instead.
  *
  * Parameters:
  * - i: Row index of the cell.
@@ -84,17 +283,12 @@ void set_cell(int i, int j, t_grid* g, char v) {
  */
 char get_cell(int i, int j, t_grid* g) {
     // Check if coordinates are within bounds
-    if (i < 0 || i >= g->size || j < 0 || j >= g->size) {
-        if (option.verbose) {
-            fprintf(stderr, "Warning: Coordinates (%d, %d) are out of bounds for the grid. (Function: get_cell)\n", i, j);
-        }
+    if (i < 0 || i >= g->rows || j < 0 || j >= g->cols) {
+        LOG_INFO("Warning: Coordinates (%d, %d) are out of bounds for the grid. (Function: get_cell)\n", i, j);
         // Return an invalid character to indicate an error
         return ' ';
     }
-
-    // Calculate the index corresponding to the (i, j) coordinates
-    int index = i * g->size + j;
-    return g->grid[index];
+    return grid_cell(g, i, j);
 }
 
 
@@ -111,36 +305,28 @@ char get_cell(int i, int j, t_grid* g) {
 bool is_consistent(t_grid* g) {
     // Check for identical rows or columns
     if (!check_same_col_or_row(g)) {
-        if (option.verbose) {
-            fprintf(stderr, "Warning: Invalid same col or row. (Function: is_consistent)\n");
-        }
+        LOG_DEBUG("Warning: Invalid same col or row. (Function: is_consistent)\n");
         return false;
     }
 
     // Check for the correct number of zeros and ones
     if (!check_number_of_zeros_ones(g)) {
-        if (option.verbose) {
-            fprintf(stderr, "Warning: Invalid number of zeros or ones. (Function: is_consistent)\n");
-        }
+        LOG_DEBUG("Warning: Invalid number of zeros or ones. (Function: is_consistent)\n");
         return false;
     }
 
     // Check for consecutive zeros and ones in rows
-    for (int row = 0; row < g->size; row++) {
+    for (int row = 0; row < g->rows; row++) {
         if (!check_consecutive_zeros_ones(row, g, true)) {
-            if (option.verbose) {
-                fprintf(stderr, "Warning: Invalid consecutive zeros or ones in row %d. (Function: is_consistent)\n", row);
-            }
+            LOG_DEBUG("Warning: Invalid consecutive zeros or ones in row %d. (Function: is_consistent)\n", row);
             return false;
         }
     }
 
     // Check for consecutive zeros and ones in columns
-    for (int col = 0; col < g->size; col++) {
+    for (int col = 0; col < g->cols; col++) {
         if (!check_consecutive_zeros_ones(col, g, false)) {
-            if (option.verbose) {
-                fprintf(stderr, "Warning: Invalid consecutive zeros or ones in column %d. (Function: is_consistent)\n", col);
-            }
+            LOG_DEBUG("Warning: Invalid consecutive zeros or ones in column %d. (Function: is_consistent)\n", col);
             return false;
         }
     }
@@ -149,6 +335,71 @@ bool is_consistent(t_grid* g) {
 }
 
 
+// Complete line, used to find identical lines by sorting
+typedef struct {
+    const uint64_t* ones;
+    int words;
+    int index;
+} t_line_key;
+
+
+static int line_key_compare(const void* a, const void* b) {
+    const t_line_key* key_a = (const t_line_key*)a;
+    const t_line_key* key_b = (const t_line_key*)b;
+    int order = line_compare(key_a->ones, key_b->ones, key_a->words);
+    return (order != 0) ? order : key_a->index - key_b->index;
+}
+
+
+/*
+ * Looks for two identical complete lines among the packed rows (or columns) of a grid.
+ * Complete lines are sorted, so identical lines end up next to each other:
+ * O(count log count) comparisons of packed lines instead of comparing every pair.
+ * Only used to report the identical lines, the sets of complete lines of the grid
+ * telling whether there are any.
+ *
+ * Parameters:
+ * - filled: Packed 'filled' bitsets of the lines.
+ * - ones: Packed 'ones' bitsets of the lines.
+ * - count: Number of lines.
+ * - length: Number of cells in each line.
+ * - is_row: Boolean indicating whether the lines are rows (true) or columns (false).
+ *
+ * Returns:
+ * True if at least two complete lines are identical; otherwise, false.
+ */
+static bool lines_have_duplicate(const uint64_t* filled, const uint64_t* ones, int count, int length, bool is_row) {
+    int words = LINE_WORDS(length);
+    t_line_key* keys = malloc(count * sizeof(t_line_key));
+    if (keys == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in lines_have_duplicate.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int complete = 0;
+    for (int line = 0; line < count; line++) {
+        if (line_is_full(filled + line * words, length)) {
+            keys[complete].ones = ones + line * words;
+            keys[complete].words = words;
+            keys[complete].index = line;
+            complete++;
+        }
+    }
+    qsort(keys, complete, sizeof(t_line_key), line_key_compare);
+
+    bool foundIdentical = false;
+    for (int k = 1; k < complete; k++) {
+        if (line_equal(keys[k - 1].ones, keys[k].ones, words)) {
+            LOG_DEBUG("Warning: Identical %s found: %d %d\n", is_row ? "rows" : "columns", keys[k - 1].index, keys[k].index);
+            foundIdentical = true;
+        }
+    }
+
+    free(keys);
+    return foundIdentical;
+}
+
+
 /**
  * Checks if there are any identical rows or columns in the given Takuzu grid.
  *
@@ -163,34 +414,18 @@ bool check_same_col_or_row(t_grid* g) {
         fprintf(stderr, "Error: Grid is NULL in check_same_col_or_row.\n");
         return false;
     }
-    bool foundIdentical = false;
 
-    // Check for identical rows
-    for (int row1 = 0; row1 < g->size; row1++) {
-        for (int row2 = row1 + 1; row2 < g->size; row2++) {
-            if (are_rows_identical(row1, row2, g)) {
-                if (option.verbose) {
-                    fprintf(stderr, "Warning: Identical rows found: %d %d\n", row1, row2);
-                }
-                foundIdentical = true;
-            }
-        }
+    // The sets of complete lines know whether two of them are identical
+    if (!grid_has_identical_lines(g)) {
+        return true;
     }
 
-    // Check for identical columns
-    for (int col1 = 0; col1 < g->size; col1++) {
-        for (int col2 = col1 + 1; col2 < g->size; col2++) {
-            if (are_columns_identical(col1, col2, g)) {
-                if (option.verbose) {
-                    fprintf(stderr, "Warning: Identical columns found: %d %d\n", col1, col2);
-                }
-                foundIdentical = true;
-            }
-        }
+    // Sort the complete rows, then the complete columns, to name the identical ones
+    if (LOG_LEVEL >= LOG_LEVEL_DEBUG && log_verbose) {
+        lines_have_duplicate(g->row_filled, g->row_ones, g->rows, g->cols, true);
+        lines_have_duplicate(g->col_filled, g->col_ones, g->cols, g->rows, false);
     }
-
-    // Return false only if at least one pair of identical rows or columns is found
-    return !foundIdentical;
+    return false;
 }
 
 
@@ -204,15 +439,11 @@ bool check_same_col_or_row(t_grid* g) {
  * - g: Pointer to the Takuzu grid.
  *
  * Returns:
- * True if the rows are identical; otherwise, false.
+ * True if the rows are complete and identical; otherwise, false.
  */
 bool are_rows_identical(int row1, int row2, t_grid* g) {
-    for (int col = 0; col < g->size; col++) {
-        if (get_cell(row1, col, g) != get_cell(row2, col, g) || get_cell(row1, col, g) == '_') {
-            return false;
-        }
-    }
-    return true;
+    return g->row_empty[row1] == 0 && g->row_empty[row2] == 0 &&
+        line_equal(g->row_ones + row1 * g->row_words, g->row_ones + row2 * g->row_words, g->row_words);
 }
 
 
@@ -226,21 +457,18 @@ bool are_rows_identical(int row1, int row2, t_grid* g) {
  * - g: Pointer to the Takuzu grid.
  *
  * Returns:
- * True if the columns are identical; otherwise, false.
+ * True if the columns are complete and identical; otherwise, false.
  */
 bool are_columns_identical(int col1, int col2, t_grid* g) {
-    for (int row = 0; row < g->size; row++) {
-        if (get_cell(row, col1, g) != get_cell(row, col2, g) || get_cell(row, col1, g) == '_') {
-            return false;
-        }
-    }
-    return true;
+    return g->col_empty[col1] == 0 && g->col_empty[col2] == 0 &&
+        line_equal(g->col_ones + col1 * g->col_words, g->col_ones + col2 * g->col_words, g->col_words);
 }
 
 
 /*
  * Checks for consecutive occurrences of '0' or '1' in a row or column of the Takuzu grid.
  * Returns true if no more than two consecutive '0' or '1' are found; otherwise, returns false.
+ * Works on the packed line with shifts, one word of 64 cells at a time.
  *
  * Parameters:
  * - index: Index of the row or column to check for consecutive occurrences.
@@ -250,45 +478,23 @@ bool are_columns_identical(int col1, int col2, t_grid* g) {
  * Returns:
  * True if no more than two consecutive '0' or '1' are found; otherwise, false.
  * If the grid pointer is NULL, an error message is displayed, and false is returned.
- * Displays warnings if more than two consecutive '0' or '1' are found in the grid.
  */
 bool check_consecutive_zeros_ones(int index, t_grid* g, bool is_row) {
     if (g == NULL) {
         fprintf(stderr, "Error: Grid is NULL in check_consecutive_zeros_ones.\n");
         return false;
     }
-    int consecutive_zeros = 0;
-    int consecutive_ones = 0;
-
-    for (int i = 0; i < g->size; i++) {
-        char current = is_row ? get_cell(index, i, g) : get_cell(i, index, g);
-
-        switch (current) {
-        case '0':
-            consecutive_zeros++;
-            consecutive_ones = 0;
-            break;
-        case '1':
-            consecutive_ones++;
-            consecutive_zeros = 0;
-            break;
-        default:
-            consecutive_zeros = 0;
-            consecutive_ones = 0;
-            break;
-        }
-
-        if (consecutive_zeros > 2 || consecutive_ones > 2) {
-            return false;
-        }
-    }
-    return true;
+    int words = is_row ? g->row_words : g->col_words;
+    const uint64_t* filled = (is_row ? g->row_filled : g->col_filled) + index * words;
+    const uint64_t* ones = (is_row ? g->row_ones : g->col_ones) + index * words;
+    return !line_has_triple(filled, ones, words);
 }
 
 
 /*
  * Checks the number of '0' and '1' in each row and column of the Takuzu grid.
  * Returns true if the number of '0' and '1' is consistent; otherwise, returns false.
+ * Counts are population counts of the packed lines.
  *
  * Parameters:
  * - g: Pointer to the Takuzu grid.
@@ -296,7 +502,6 @@ bool check_consecutive_zeros_ones(int index, t_grid* g, bool is_row) {
  * Returns:
  * True if the number of '0's and '1's is consistent; otherwise, false.
  * If the grid pointer is NULL, an error message is displayed, and false is returned.
- * Displays warnings if the number of '0's or '1's exceeds half of the row or column size.
  */
 bool check_number_of_zeros_ones(t_grid* g) {
     if (g == NULL) {
@@ -304,48 +509,56 @@ bool check_number_of_zeros_ones(t_grid* g) {
         return false;
     }
 
-    int size = g->size;
+    // Check the number of '0's and '1's in each row, then in each column
+    for (int pass = 0; pass < 2; pass++) {
+        const uint64_t* filled = (pass == 0) ? g->row_filled : g->col_filled;
+        const uint64_t* ones = (pass == 0) ? g->row_ones : g->col_ones;
+        int count = (pass == 0) ? g->rows : g->cols;
+        int length = (pass == 0) ? g->cols : g->rows;
+        int words = LINE_WORDS(length);
 
-    // Check the number of '0's and '1's in each row
-    for (int row = 0; row < size; row++) {
-        int zeroCount = 0;
-        int oneCount = 0;
+        for (int line = 0; line < count; line++) {
+            int oneCount = line_popcount(ones + line * words, words);
+            int zeroCount = line_popcount(filled + line * words, words) - oneCount;
 
-        for (int col = 0; col < size; col++) {
-            char cell = get_cell(row, col, g);
-
-            if (cell == '0') {
-                zeroCount++;
-            }
-            else if (cell == '1') {
-                oneCount++;
+            if (zeroCount > length / 2 || oneCount > length / 2) {
+                return false;
             }
         }
-
-        if (zeroCount > size / 2 || oneCount > size / 2) {
-            return false;
-        }
     }
 
-    // Check the number of '0's and '1's in each column
-    for (int col = 0; col < size; col++) {
-        int zeroCount = 0;
-        int oneCount = 0;
+    return true;
+}
 
-        for (int row = 0; row < size; row++) {
-            char cell = get_cell(row, col, g);
 
-            if (cell == '0') {
-                zeroCount++;
-            }
-            else if (cell == '1') {
-                oneCount++;
+/*
+ * Checks the validity of the Takuzu grid.
+ * Returns true if the grid is valid; otherwise, returns false.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid.
+ *
+ * Returns:
+ * True if the grid is valid; otherwise, false.
+ * If the grid is inconsistent, an error message is displayed (in verbose mode), and false is returned.
+ * Displays a warning (in verbose mode) if an empty cell is found, and false is returned.
+ */
+bool is_valid(t_grid* g) {
+    // A complete grid has no empty cell left to count, an O(1) test done first
+    if (g->empty > 0) {
+        if (LOG_LEVEL >= LOG_LEVEL_INFO && log_verbose) {
+            int cell = 0;
+            while (g->grid[cell] == '0' || g->grid[cell] == '1') {
+                cell++;
             }
+            fprintf(stderr, "Warning: Found an empty cell at (%d, %d).\n", cell / g->cols, cell % g->cols);
         }
+        return false;
+    }
 
-        if (zeroCount > size / 2 || oneCount > size / 2) {
-            return false;
-        }
+    if (!is_consistent(g)) {
+        LOG_INFO("Error: Grid is inconsistent.\n");
+        return false;
     }
 
     return true;
@@ -353,39 +566,91 @@ bool check_number_of_zeros_ones(t_grid* g) {
 
 
 /*
- * Checks the validity of the Takuzu grid.
- * Returns true if the grid is valid; otherwise, returns false.
+ * Fills a cell of a row or of a column, given by its position in the line.
+ */
+static inline void line_set_cell(t_grid* g, bool is_row, int index, int k, char v) {
+    if (is_row) {
+        grid_fill_cell(g, index, k, v);
+    }
+    else {
+        grid_fill_cell(g, k, index, v);
+    }
+}
+
+
+/*
+ * Fills the empty cells of the rows (or columns) holding half of their cells of one
+ * value with the other value. Rows are read in the cells and columns in their
+ * column-major copy, so both scan contiguous memory.
  *
  * Parameters:
  * - g: Pointer to the Takuzu grid.
+ * - is_row: Boolean indicating whether to fill rows (true) or columns (false).
+ * - counted: The value counted, '0' or '1'.
+ * - fill: The value written in the empty cells.
  *
  * Returns:
- * True if the grid is valid; otherwise, false.
- * If the grid is inconsistent, an error message is displayed (if option.verbose is enabled), and false is returned.
- * Displays a warning (if option.verbose is enabled) if an empty cell is found, and false is returned.
+ * True if the grid is modified; otherwise, false.
  */
-bool is_valid(t_grid* g) {
-    if (!is_consistent(g)) {
-        if (option.verbose) {
-            fprintf(stderr, "Error: Grid is inconsistent.\n");
+static bool fill_half_lines(t_grid* g, bool is_row, char counted, char fill) {
+    bool gridChanged = false;
+    int count = is_row ? g->rows : g->cols;
+    int length = is_row ? g->cols : g->rows;
+
+    for (int index = 0; index < count; index++) {
+        const char* line = grid_line(g, is_row, index);
+        int valueCount = 0;
+        for (int k = 0; k < length; k++) {
+            valueCount += (line[k] == counted);
         }
-        return false;
-    }
 
-    // Check if there are any empty cells
-    for (int row = 0; row < g->size; row++) {
-        for (int col = 0; col < g->size; col++) {
-            char cell = get_cell(row, col, g);
-            if (cell != '0' && cell != '1') {
-                if (option.verbose) {
-                    fprintf(stderr, "Warning: Found an empty cell at (%d, %d).\n", row, col);
+        if (valueCount == length / 2) {
+            for (int k = 0; k < length; k++) {
+                if (line[k] == '_') {
+                    line_set_cell(g, is_row, index, k, fill);
+                    gridChanged = true;
                 }
-                return false;
             }
         }
     }
 
-    return true;
+    return gridChanged;
+}
+
+
+/*
+ * Fills the empty cells of the rows (or columns) lying between two equal values with
+ * the other value.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid.
+ * - is_row: Boolean indicating whether to fill rows (true) or columns (false).
+ *
+ * Returns:
+ * True if the grid is modified; otherwise, false.
+ */
+static bool fill_middle_cells(t_grid* g, bool is_row) {
+    bool state = false;
+    int count = is_row ? g->rows : g->cols;
+    int length = is_row ? g->cols : g->rows;
+
+    for (int index = 0; index < count; index++) {
+        const char* line = grid_line(g, is_row, index);
+        for (int k = 1; k < length - 1; k++) {
+            if (line[k] == '_') {
+                if (line[k - 1] == '0' && line[k + 1] == '0') {
+                    line_set_cell(g, is_row, index, k, '1');
+                    state = true;
+                }
+
+                if (line[k - 1] == '1' && line[k + 1] == '1') {
+                    line_set_cell(g, is_row, index, k, '0');
+                    state = true;
+                }
+            }
+        }
+    }
+    return state;
 }
 
 
@@ -406,31 +671,22 @@ bool apply_consecutive_zeros_ones_rows(t_grid* g) {
     }
     bool gridChanged = false;
 
-    for (int row = 0; row < g->size; row++) {
-        for (int col = 0; col < g->size - 2; col++) {
+    for (int row = 0; row < g->rows; row++) {
+        const char* line = grid_line(g, true, row);
+        for (int col = 0; col < g->cols - 2; col++) {
             // Search for two consecutive zeros in the row
-            if (get_cell(row, col, g) == '0' && get_cell(row, col + 1, g) == '0') {
+            if (line[col] == '0' && line[col + 1] == '0') {
                 // Check the possibility of placing '1' at the third position
-                if (col + 2 < g->size && get_cell(row, col + 2, g) == '_') {
-                    set_cell(row, col + 2, g, '1');
-                    gridChanged = true;
-                }
-                // If the third position is outside the grid, try adding '1' at the first available position before the zeros
-                if (col + 2 >= g->size && col - 1 >= 0 && get_cell(row, col - 1, g) == '_') {
-                    set_cell(row, col - 1, g, '1');
+                if (line[col + 2] == '_') {
+                    grid_fill_cell(g, row, col + 2, '1');
                     gridChanged = true;
                 }
             }
             // Search for two consecutive ones in the row
-            if (get_cell(row, col, g) == '1' && get_cell(row, col + 1, g) == '1') {
+            if (line[col] == '1' && line[col + 1] == '1') {
                 // Check the possibility of placing '0' at the third position
-                if (col + 2 < g->size && get_cell(row, col + 2, g) == '_') {
-                    set_cell(row, col + 2, g, '0');
-                    gridChanged = true;
-                }
-                // If the third position is outside the grid, try adding '0' at the first available position before the ones
-                if (col + 2 >= g->size && col - 1 >= 0 && get_cell(row, col - 1, g) == '_') {
-                    set_cell(row, col - 1, g, '0');
+                if (line[col + 2] == '_') {
+                    grid_fill_cell(g, row, col + 2, '0');
                     gridChanged = true;
                 }
             }
@@ -449,259 +705,430 @@ bool apply_consecutive_zeros_ones_rows(t_grid* g) {
  *
  * Returns:
  * True if the grid is modified by the heuristic; otherwise, false.
- * Displays an error message (if option.verbose is enabled) in case of a NULL grid pointer.
+ * Displays an error message (in verbose mode) in case of a NULL grid pointer.
  */
 bool middle_pattern_heuristic(t_grid* g) {
     if (g == NULL) {
-        if (option.verbose) {
-            fprintf(stderr, "Error: Grid is NULL in middle_pattern_heuristic.\n");
-        }
+        LOG_INFO("Error: Grid is NULL in middle_pattern_heuristic.\n");
         return false;
     }
 
-    bool state = false;
+    // Row part, then column part
+    bool state = fill_middle_cells(g, true);
+    if (fill_middle_cells(g, false)) {
+        state = true;
+    }
+    return state;
+}
 
-    for (int i = 0; i < g->size; i++) {
-        for (int j = 1; j < g->size; j++) {
-            // Row part
-            if (get_cell(i, j, g) == '_') {
-                if (get_cell(i, j - 1, g) == '0' && get_cell(i, j + 1, g) == '0') {
-                    set_cell(i, j, g, '1');
-                    state = true;
-                }
 
-                if (get_cell(i, j - 1, g) == '1' && get_cell(i, j + 1, g) == '1') {
-                    set_cell(i, j, g, '0');
-                    state = true;
+/*
+ * Attempts to fill empty cells based on consecutive values in columns.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid.
+ *
+ * Returns:
+ * True if the grid is modified by the heuristic; otherwise, false.
+ * Displays an error message (in verbose mode) in case of a NULL grid pointer.
+ */
+bool apply_consecutive_zeros_ones_columns(t_grid* g) {
+    if (g == NULL) {
+        LOG_INFO("Error: Grid is NULL in applyConsecutiveZerosOnesColumns.\n");
+        return false;
+    }
+    bool gridChanged = false;
+
+    // Columns are read in their column-major copy, one contiguous line each
+    for (int col = 0; col < g->cols; col++) {
+        const char* line = grid_line(g, false, col);
+        for (int row = 0; row < g->rows - 2; row++) {
+            if (line[row] == '0' && line[row + 1] == '0') {
+                if (line[row + 2] == '_') {
+                    grid_fill_cell(g, row + 2, col, '1');
+                    gridChanged = true;
+                }
+                if (row > 0 && line[row - 1] == '_') {
+                    grid_fill_cell(g, row - 1, col, '1');
+                    gridChanged = true;
                 }
             }
-            // Column part
-            if (get_cell(j, i, g) == '_') {
-                if (get_cell(j - 1, i, g) == '0' && get_cell(j + 1, i, g) == '0') {
-                    set_cell(j, i, g, '1');
-                    state = true;
+            if (line[row] == '1' && line[row + 1] == '1') {
+                if (line[row + 2] == '_') {
+                    grid_fill_cell(g, row + 2, col, '0');
+                    gridChanged = true;
                 }
-
-                if (get_cell(j - 1, i, g) == '1' && get_cell(j + 1, i, g) == '1') {
-                    set_cell(j, i, g, '0');
-                    state = true;
+                if (row > 0 && line[row - 1] == '_') {
+                    grid_fill_cell(g, row - 1, col, '0');
+                    gridChanged = true;
                 }
             }
         }
     }
-    return state;
+
+    return gridChanged;
+}
+
+
+/*
+ * Fills empty cells in rows where the count of '0' is half of the row length.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid.
+ *
+ * Returns:
+ * True if the grid is modified by the heuristic; otherwise, false.
+ * Displays an error message (in verbose mode) in case of a NULL grid pointer.
+ */
+bool apply_all_zeros_filled_rows(t_grid* g) {
+    if (g == NULL) {
+        LOG_INFO("Error: Grid is NULL in applyAllZerosFilledRows.\n");
+        return false;
+    }
+    return fill_half_lines(g, true, '0', '1');
+}
+
+
+/*
+ * Fills empty cells in columns where the count of '0' is half of the column length.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid.
+ *
+ * Returns:
+ * True if the grid is modified by the heuristic; otherwise, false.
+ * Displays an error message (in verbose mode) in case of a NULL grid pointer.
+ */
+bool apply_all_zeros_filled_columns(t_grid* g) {
+    if (g == NULL) {
+        LOG_INFO("Error: Grid is NULL in applyAllZerosFilledColumns.\n");
+        return false;
+    }
+    return fill_half_lines(g, false, '0', '1');
+}
+
+
+/*
+ * Fills empty cells in rows where the count of '1' is half of the row length.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid.
+ *
+ * Returns:
+ * True if the grid is modified by the heuristic; otherwise, false.
+ * Displays an error message (in verbose mode) in case of a NULL grid pointer.
+ */
+bool apply_all_ones_filled_rows(t_grid* g) {
+    if (g == NULL) {
+        LOG_INFO("Error: Grid is NULL in applyAllOnesFilledRows.\n");
+        return false;
+    }
+    return fill_half_lines(g, true, '1', '0');
+}
+
+
+/*
+ * Fills empty cells in columns where the count of '1' is half of the column length.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid.
+ *
+ * Returns:
+ * True if the grid is modified by the heuristic; otherwise, false.
+ * Displays an error message (in verbose mode) in case of a NULL grid pointer.
+ */
+bool apply_all_ones_filled_columns(t_grid* g) {
+    if (g == NULL) {
+        LOG_INFO("Error: Grid is NULL in applyAllOnesFilledColumns.\n");
+        return false;
+    }
+    return fill_half_lines(g, false, '1', '0');
+}
+
+
+/*
+ * Gives the next larger set of cells with as many cells as k (Gosper's hack), or a
+ * value past the sets of 'empty' cells after the last one.
+ */
+static inline unsigned next_combination(unsigned k, int empty) {
+    if (k == 0) {
+        return 1U << empty;
+    }
+    unsigned lowest = k & -k;
+    unsigned ripple = k + lowest;
+    return (((ripple ^ k) >> 2) / lowest) | ripple;
+}
+
+
+/*
+ * Checks if a complete row (or column) holds the values of a line on its filled
+ * cells, which any completion of the line colliding with a complete line needs.
+ */
+static bool line_has_complete_extension(const t_grid* g, bool is_row, int index) {
+    int count = is_row ? g->rows : g->cols;
+    int length = is_row ? g->cols : g->rows;
+    int words = is_row ? g->row_words : g->col_words;
+    const uint64_t* filled = is_row ? g->row_filled : g->col_filled;
+    const uint64_t* ones = is_row ? g->row_ones : g->col_ones;
+    const uint64_t* line_filled = filled + (size_t)index * words;
+    const uint64_t* line_ones = ones + (size_t)index * words;
+
+    if (words == 1) {
+        uint64_t mask = line_last_mask(length);
+        for (int other = 0; other < count; other++) {
+            if (filled[other] == mask && (ones[other] & line_filled[0]) == line_ones[0]) {
+                return true;
+            }
+        }
+        return false;
+    }
+    const int* empty = is_row ? g->row_empty : g->col_empty;
+    for (int other = 0; other < count; other++) {
+        if (empty[other] == 0 &&
+            line_extends(ones + (size_t)other * words, line_filled, line_ones, words)) {
+            return true;
+        }
+    }
+    return false;
 }
 
 
 /*
- * Attempts to fill empty cells based on consecutive values in columns.
+ * Fills the cells of a row (or column) with few empty cells on which all its
+ * completions agree once the completions equal to a complete line are left out.
+ * Each completion respecting the counts and the triples is looked up in the set of
+ * complete lines. If every completion collides, the line gets the first one, which
+ * the consistency check then rejects as a duplicate.
  *
  * Parameters:
  * - g: Pointer to the Takuzu grid.
+ * - is_row: Boolean indicating whether the line is a row (true) or a column (false).
+ * - index: Index of the line.
  *
  * Returns:
- * True if the grid is modified by the heuristic; otherwise, false.
- * Displays an error message (if option.verbose is enabled) in case of a NULL grid pointer.
+ * True if the grid is modified; otherwise, false.
  */
-bool apply_consecutive_zeros_ones_columns(t_grid* g) {
-    if (g == NULL) {
-        if (option.verbose) {
-            fprintf(stderr, "Error: Grid is NULL in applyConsecutiveZerosOnesColumns.\n");
-        }
+static bool fill_distinct_line(t_grid* g, bool is_row, int index) {
+    int length = is_row ? g->cols : g->rows;
+    int words = is_row ? g->row_words : g->col_words;
+    const uint64_t* filled = (is_row ? g->row_filled : g->col_filled) + (size_t)index * words;
+    const uint64_t* ones = (is_row ? g->row_ones : g->col_ones) + (size_t)index * words;
+    const t_lineset* set = is_row ? &g->full_rows : &g->full_cols;
+
+    int empty = (is_row ? g->row_empty : g->col_empty)[index];
+    int missing = length / 2 - line_popcount(ones, words);
+    if (empty == 0 || empty > DISTINCT_MAX_EMPTY || missing < 0 || missing > empty ||
+        !line_has_complete_extension(g, is_row, index)) {
         return false;
     }
-    bool gridChanged = false;
 
-    for (int col = 0; col < g->size; col++) {
-        for (int row = 0; row < g->size - 2; row++) {
-            if (get_cell(row, col, g) == '0' && get_cell(row + 1, col, g) == '0') {
-                if (get_cell(row + 2, col, g) == '_') {
-                    set_cell(row + 2, col, g, '1');
-                    gridChanged = true;
-                }
-                if (get_cell(row - 1, col, g) == '_') {
-                    set_cell(row - 1, col, g, '1');
-                    gridChanged = true;
-                }
-            }
-            if (get_cell(row, col, g) == '1' && get_cell(row + 1, col, g) == '1') {
-                if (get_cell(row + 2, col, g) == '_') {
-                    set_cell(row + 2, col, g, '0');
-                    gridChanged = true;
-                }
-                if (get_cell(row - 1, col, g) == '_') {
-                    set_cell(row - 1, col, g, '0');
-                    gridChanged = true;
-                }
-            }
+    int cells[DISTINCT_MAX_EMPTY];
+    int found = 0;
+    for (int w = 0; w < words; w++) {
+        uint64_t holes = ~filled[w] & ((w == words - 1) ? line_last_mask(length) : ~0ULL);
+        for (; holes != 0; holes &= holes - 1) {
+            cells[found++] = 64 * w + __builtin_ctzll(holes);
+        }
+    }
+
+    // Completion k puts '1' in the empty cells whose bit is set in k
+    uint64_t complete[LINE_WORDS(MAX_GRID_SIZE)];
+    uint64_t candidate[LINE_WORDS(MAX_GRID_SIZE)];
+    for (int w = 0; w < words; w++) {
+        complete[w] = (w == words - 1) ? line_last_mask(length) : ~0ULL;
+    }
+    unsigned can_be_one = 0;
+    unsigned can_be_zero = 0;
+    int colliding = -1;
+    for (unsigned k = (1U << missing) - 1; k < (1U << empty); k = next_combination(k, empty)) {
+        memcpy(candidate, ones, words * sizeof(uint64_t));
+        for (int c = 0; c < empty; c++) {
+            candidate[cells[c] / 64] |= (uint64_t)((k >> c) & 1) << (cells[c] % 64);
+        }
+        if (line_has_triple(complete, candidate, words)) {
+            continue;
+        }
+        if (lineset_contains(set, is_row ? g->row_ones : g->col_ones, words, candidate)) {
+            colliding = (colliding < 0) ? (int)k : colliding;
+            continue;
         }
+        can_be_one |= k;
+        can_be_zero |= ~k;
+    }
+    if (colliding < 0) {
+        // Without a collision, the other rules see the same completions
+        return false;
+    }
+    if (can_be_one == 0 && can_be_zero == 0) {
+        can_be_one = (unsigned)colliding;
+        can_be_zero = ~(unsigned)colliding;
     }
 
+    bool gridChanged = false;
+    for (int c = 0; c < empty; c++) {
+        bool one = (can_be_one >> c) & 1;
+        bool zero = (can_be_zero >> c) & 1;
+        if (one != zero) {
+            line_set_cell(g, is_row, index, cells[c], one ? '1' : '0');
+            gridChanged = true;
+        }
+    }
     return gridChanged;
 }
 
 
 /*
- * Fills empty cells in rows where the count of '0' is half of the grid size.
+ * Distinct lines rule: a row (or column) with at most DISTINCT_MAX_EMPTY empty cells
+ * gets the cells on which all its completions agree, leaving out the completions
+ * that would make it identical to a complete row (or column). Does nothing while no
+ * line is complete.
  *
  * Parameters:
  * - g: Pointer to the Takuzu grid.
  *
  * Returns:
- * True if the grid is modified by the heuristic; otherwise, false.
- * Displays an error message (if option.verbose is enabled) in case of a NULL grid pointer.
+ * True if the grid is modified by the rule; otherwise, false.
  */
-bool apply_all_zeros_filled_rows(t_grid* g) {
+bool apply_distinct_lines(t_grid* g) {
     if (g == NULL) {
-        if (option.verbose) {
-            fprintf(stderr, "Error: Grid is NULL in applyAllZerosFilledRows.\n");
-        }
+        fprintf(stderr, "Error: Grid is NULL in apply_distinct_lines.\n");
         return false;
     }
-    bool gridChanged = false;
 
-    for (int row = 0; row < g->size; row++) {
-        int zeroCount = 0;
-        for (int col = 0; col < g->size; col++) {
-            if (get_cell(row, col, g) == '0') {
-                zeroCount++;
-            }
+    bool gridChanged = false;
+    for (int i = 0; i < g->rows && g->full_rows.count > 0; i++) {
+        if (fill_distinct_line(g, true, i)) {
+            gridChanged = true;
         }
-
-        if (zeroCount == g->size / 2) {
-            for (int col = 0; col < g->size; col++) {
-                if (get_cell(row, col, g) == '_') {
-                    set_cell(row, col, g, '1');
-                    gridChanged = true;
-                }
-            }
+    }
+    for (int j = 0; j < g->cols && g->full_cols.count > 0; j++) {
+        if (fill_distinct_line(g, false, j)) {
+            gridChanged = true;
         }
     }
-
     return gridChanged;
 }
 
 
 /*
- * Fills empty cells in columns where the count of '0' is half of the grid size.
+ * Applies the distinct lines rule around a line that changed: to the line itself
+ * while it has empty cells, and once it is complete, to the lines that it extends,
+ * for which it is a new completion to avoid.
  *
  * Parameters:
  * - g: Pointer to the Takuzu grid.
+ * - is_row: Boolean indicating whether the line is a row (true) or a column (false).
+ * - index: Index of the line.
  *
  * Returns:
- * True if the grid is modified by the heuristic; otherwise, false.
- * Displays an error message (if option.verbose is enabled) in case of a NULL grid pointer.
+ * True if the grid is modified; otherwise, false.
  */
-bool apply_all_zeros_filled_columns(t_grid* g) {
-    if (g == NULL) {
-        if (option.verbose) {
-            fprintf(stderr, "Error: Grid is NULL in applyAllZerosFilledColumns.\n");
-        }
+static bool fill_distinct_around(t_grid* g, bool is_row, int index) {
+    if ((is_row ? g->full_rows.count : g->full_cols.count) == 0) {
         return false;
     }
-    bool gridChanged = false;
-
-    for (int col = 0; col < g->size; col++) {
-        int zeroCount = 0;
+    int count = is_row ? g->rows : g->cols;
+    int length = is_row ? g->cols : g->rows;
+    int words = is_row ? g->row_words : g->col_words;
+    const uint64_t* filled = is_row ? g->row_filled : g->col_filled;
+    const uint64_t* ones = is_row ? g->row_ones : g->col_ones;
+    const int* empty = is_row ? g->row_empty : g->col_empty;
+    const uint64_t* full_ones = ones + (size_t)index * words;
+    if (empty[index] != 0) {
+        return fill_distinct_line(g, is_row, index);
+    }
 
-        for (int row = 0; row < g->size; row++) {
-            if (get_cell(row, col, g) == '0') {
-                zeroCount++;
+    bool gridChanged = false;
+    if (words == 1) {
+        uint64_t mask = line_last_mask(length);
+        for (int other = 0; other < count; other++) {
+            if (filled[other] != mask && (full_ones[0] & filled[other]) == ones[other]) {
+                gridChanged = fill_distinct_line(g, is_row, other) || gridChanged;
             }
         }
-
-        if (zeroCount == g->size / 2) {
-            for (int row = 0; row < g->size; row++) {
-                if (get_cell(row, col, g) == '_') {
-                    set_cell(row, col, g, '1');
-                    gridChanged = true;
-                }
-            }
+        return gridChanged;
+    }
+    for (int other = 0; other < count; other++) {
+        const uint64_t* other_filled = filled + (size_t)other * words;
+        if (empty[other] != 0 &&
+            line_extends(full_ones, other_filled, ones + (size_t)other * words, words)) {
+            gridChanged = fill_distinct_line(g, is_row, other) || gridChanged;
         }
     }
-
     return gridChanged;
 }
 
 
 /*
- * Fills empty cells in rows where the count of '1' is half of the grid size.
+ * Applies the distinct lines rule to a grid on which it was stable when the trail
+ * had 'mark' cells. Only the lines of the cells filled since then, and the lines
+ * that those lines extend once complete, can get new cells.
  *
  * Parameters:
- * - g: Pointer to the Takuzu grid.
+ * - g: Pointer to the Takuzu grid, with a trail.
+ * - mark: Trail length at which the rule was last stable.
  *
  * Returns:
- * True if the grid is modified by the heuristic; otherwise, false.
- * Displays an error message (if option.verbose is enabled) in case of a NULL grid pointer.
+ * True if the grid is modified by the rule; otherwise, false.
  */
-bool apply_all_ones_filled_rows(t_grid* g) {
-    if (g == NULL) {
-        if (option.verbose) {
-            fprintf(stderr, "Error: Grid is NULL in applyAllOnesFilledRows.\n");
-        }
-        return false;
-    }
+bool apply_distinct_lines_since(t_grid* g, int mark) {
+    int end = g->trail_length;
     bool gridChanged = false;
 
-    for (int row = 0; row < g->size; row++) {
-        int oneCount = 0;
-
-        for (int col = 0; col < g->size; col++) {
-            if (get_cell(row, col, g) == '1') {
-                oneCount++;
-            }
-        }
-
-        if (oneCount == g->size / 2) {
-            for (int col = 0; col < g->size; col++) {
-                if (get_cell(row, col, g) == '_') {
-                    set_cell(row, col, g, '0');
-                    gridChanged = true;
-                }
-            }
+    // The trail holds the cells of a row in runs, so a row is seldom visited twice
+    int last_row = -1;
+    for (int t = mark; t < end; t++) {
+        int i = g->trail[t] / g->cols;
+        int j = g->trail[t] - i * g->cols;
+        if (i != last_row) {
+            gridChanged = fill_distinct_around(g, true, i) || gridChanged;
+            last_row = i;
         }
+        gridChanged = fill_distinct_around(g, false, j) || gridChanged;
     }
-
     return gridChanged;
 }
 
 
 /*
- * Fills empty cells in columns where the count of '1' is half of the grid size.
+ * Applies every basic heuristic once to the Takuzu grid.
  *
  * Parameters:
  * - g: Pointer to the Takuzu grid.
  *
  * Returns:
- * True if the grid is modified by the heuristic; otherwise, false.
- * Displays an error message (if option.verbose is enabled) in case of a NULL grid pointer.
+ * True if at least one heuristic changed the grid; otherwise, false.
  */
-bool apply_all_ones_filled_columns(t_grid* g) {
-    if (g == NULL) {
-        if (option.verbose) {
-            fprintf(stderr, "Error: Grid is NULL in applyAllOnesFilledColumns.\n");
-        }
-        return false;
-    }
+bool apply_heuristics_once(t_grid* g) {
     bool gridChanged = false;
 
-    for (int col = 0; col < g->size; col++) {
-        int oneCount = 0;
+    // Apply various heuristics in a potentially optimized order
+    if (apply_all_zeros_filled_rows(g)) {
+        gridChanged = true;
+    }
 
-        for (int row = 0; row < g->size; row++) {
-            if (get_cell(row, col, g) == '1') {
-                oneCount++;
-            }
-        }
+    if (apply_all_zeros_filled_columns(g)) {
+        gridChanged = true;
+    }
 
-        if (oneCount == g->size / 2) {
-            for (int row = 0; row < g->size; row++) {
-                if (get_cell(row, col, g) == '_') {
-                    set_cell(row, col, g, '0');
-                    gridChanged = true;
-                }
-            }
-        }
+    if (apply_all_ones_filled_rows(g)) {
+        gridChanged = true;
+    }
+
+    if (apply_all_ones_filled_columns(g)) {
+        gridChanged = true;
+    }
+
+    if (apply_consecutive_zeros_ones_rows(g)) {
+        gridChanged = true;
+    }
+
+    if (apply_consecutive_zeros_ones_columns(g)) {
+        gridChanged = true;
+    }
+
+    if (middle_pattern_heuristic(g)) {
+        gridChanged = true;
     }
 
     return gridChanged;
@@ -714,55 +1141,30 @@ bool apply_all_ones_filled_columns(t_grid* g) {
  * Parameters:
  * - g: Pointer to the Takuzu grid.
  *
+ * Returns:
+ * The number of rounds that changed the grid, or -1 if the grid is NULL or inconsistent.
+ *
  * Note:
  * The function applies heuristics in a potentially optimized order to improve efficiency.
  * In case of errors or inconsistencies, appropriate error messages are displayed.
  */
-void apply_heuristics_until_stable(t_grid* g) {
+int apply_heuristics_until_stable(t_grid* g) {
     if (g == NULL) {
         fprintf(stderr, "Error: Grid is NULL in apply_heuristics_until_stable.\n");
-        return;
+        return -1;
     }
 
     // Check if the initial grid is consistent
     if (!is_consistent(g)) {
         fprintf(stderr, "Error: Inconsistent grid. No need to try solving it!\n");
-        return;
+        return -1;
     }
 
-    bool gridChanged = true;
-    while (gridChanged) {
-        gridChanged = false;
-
-        // Apply various heuristics in a potentially optimized order
-        if (apply_all_zeros_filled_rows(g)) {
-            gridChanged = true;
-        }
-
-        if (apply_all_zeros_filled_columns(g)) {
-            gridChanged = true;
-        }
-
-        if (apply_all_ones_filled_rows(g)) {
-            gridChanged = true;
-        }
-
-        if (apply_all_ones_filled_columns(g)) {
-            gridChanged = true;
-        }
-
-        if (apply_consecutive_zeros_ones_rows(g)) {
-            gridChanged = true;
-        }
-
-        if (apply_consecutive_zeros_ones_columns(g)) {
-            gridChanged = true;
-        }
-
-        if (middle_pattern_heuristic(g)) {
-            gridChanged = true;
-        }
+    int rounds = 0;
+    while (apply_heuristics_once(g)) {
+        rounds++;
     }
+    return rounds;
 }
 
 
@@ -787,7 +1189,7 @@ bool check_consistency_after_placement(t_grid* g, int row, int col, char cell_va
 
     // Allocate and copy the current grid to avoid modification
     t_grid gd;
-    grid_allocate(&gd, g->size);
+    grid_allocate(&gd, g->rows, g->cols);
     grid_copy(g, &gd);
 
     // Modify the copy with the new value
@@ -800,14 +1202,95 @@ bool check_consistency_after_placement(t_grid* g, int row, int col, char cell_va
     grid_free(&gd);
 
     // Display a message if the grid is inconsistent or an error occurs
-    if (!consistency && option.verbose) {
-        fprintf(stderr, "Warning: Placement of cell at (%d, %d) with value '%c' resulted in inconsistency.\n", row, col, cell_value);
+    if (!consistency) {
+        LOG_INFO("Warning: Placement of cell at (%d, %d) with value '%c' resulted in inconsistency.\n", row, col, cell_value);
     }
 
     return consistency;
 }
 
 
+/*
+ * Checks, without copying the grid, if placing a value at the specified coordinates keeps
+ * the row and the column of the cell consistent. Only the lines of the cell can become
+ * inconsistent, so this is a local O(rows + cols) check instead of a full is_consistent.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid (assumed consistent).
+ * - row: Row index of the cell placement.
+ * - col: Column index of the cell placement.
+ * - value: Value to be placed ('0' or '1').
+ *
+ * Returns:
+ * True if the grid remains consistent after the placement; otherwise, false.
+ */
+bool is_placement_consistent(t_grid* g, int row, int col, char value) {
+    const char* row_line = grid_line(g, true, row);
+    const char* col_line = grid_line(g, false, col);
+
+    // No three identical values in the windows containing the cell; the cells beyond
+    // the edges of the grid match no value
+    for (int start = -2; start <= 0; start++) {
+        int row_run = 0;
+        int col_run = 0;
+        for (int k = start; k < start + 3; k++) {
+            if (k == 0) {
+                row_run++;
+                col_run++;
+                continue;
+            }
+            if (col + k >= 0 && col + k < g->cols && row_line[col + k] == value) {
+                row_run++;
+            }
+            if (row + k >= 0 && row + k < g->rows && col_line[row + k] == value) {
+                col_run++;
+            }
+        }
+        if (row_run == 3 || col_run == 3) {
+            return false;
+        }
+    }
+
+    // Balance of the row and of the column, and completeness of both lines
+    int row_count = 1;
+    int col_count = 1;
+    bool row_full = true;
+    bool col_full = true;
+    for (int i = 0; i < g->cols; i++) {
+        row_count += (i != col && row_line[i] == value);
+        row_full = row_full && (i == col || row_line[i] != '_');
+    }
+    for (int i = 0; i < g->rows; i++) {
+        col_count += (i != row && col_line[i] == value);
+        col_full = col_full && (i == row || col_line[i] != '_');
+    }
+    if (row_count > g->cols / 2 || col_count > g->rows / 2) {
+        return false;
+    }
+
+    // A line completed by the placement must differ from the other complete lines,
+    // looked up in the sets of complete lines of the grid
+    uint64_t line[LINE_WORDS(MAX_GRID_SIZE)];
+    uint64_t bit = (value == '1');
+    if (row_full) {
+        memcpy(line, g->row_ones + (size_t)row * g->row_words, g->row_words * sizeof(uint64_t));
+        line[col / 64] |= bit << (col % 64);
+        if (lineset_contains(&g->full_rows, g->row_ones, g->row_words, line)) {
+            return false;
+        }
+    }
+    if (col_full) {
+        memcpy(line, g->col_ones + (size_t)col * g->col_words, g->col_words * sizeof(uint64_t));
+        line[row / 64] |= bit << (row % 64);
+        if (lineset_contains(&g->full_cols, g->col_ones, g->col_words, line)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
 /*
  * Places a cell strategically at the specified coordinates in the Takuzu grid.
  * Chooses between '0' and '1' based on consistency checks after placement.
@@ -816,12 +1299,13 @@ bool check_consistency_after_placement(t_grid* g, int row, int col, char cell_va
  * - g: Pointer to the Takuzu grid.
  * - row: Row index for cell placement.
  * - col: Column index for cell placement.
+ * - rng: Random generator used when both values are possible.
  *
  * Returns:
  * '0', '1', or '_' based on the strategic placement choice.
  * If an error occurs, or the grid is inconsistent, a message may be displayed.
  */
-char place_cell_strategically(t_grid* g, int row, int col) {
+char place_cell_strategically(t_grid* g, int row, int col, t_rng* rng) {
     // Check for NULL grid
     if (g == NULL) {
         fprintf(stderr, "Error: Grid is NULL in place_cell_strategically.\n");
@@ -829,10 +1313,10 @@ char place_cell_strategically(t_grid* g, int row, int col) {
     }
 
     // Check if placing a '0' is consistent
-    bool is_zero_consistent = check_consistency_after_placement(g, row, col, '0');
+    bool is_zero_consistent = is_placement_consistent(g, row, col, '0');
 
     // Check if placing a '1' is consistent
-    bool is_one_consistent = check_consistency_after_placement(g, row, col, '1');
+    bool is_one_consistent = is_placement_consistent(g, row, col, '1');
 
     // If both '0' and '1' placements are inconsistent, do nothing
     if (!is_zero_consistent && !is_one_consistent) {
@@ -841,7 +1325,7 @@ char place_cell_strategically(t_grid* g, int row, int col) {
 
     // If both '0' and '1' placements are consistent, choose randomly between '0' and '1'
     if (is_zero_consistent && is_one_consistent) {
-        return (rand() % 2 == 0) ? '0' : '1';
+        return rng_bit(rng) ? '1' : '0';
     }
 
     // If placing '0' is consistent, choose '0'
@@ -860,85 +1344,177 @@ char place_cell_strategically(t_grid* g, int row, int col) {
 
 
 /*
- * Generates a random Takuzu grid with a specified percentage of filled cells.
+ * Fills a grid with a random solution, then clears cells along a random permutation
+ * until only the wanted number of cells is left. The solution comes from the solver
+ * trying a random value first at each decision; a search that exceeds its node budget
+ * is restarted, up to MAX_FILL_ATTEMPTS times, since a random search that wanders into
+ * a dead subtree is better abandoned than exhausted.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid to be generated.
+ * - num_cells_to_fill: Number of cells left filled.
+ * - order: Buffer of rows * cols integers for the permutation.
+ * - cancel: Flag that stops the search once set (NULL: none).
+ * - rng: Random generator owned by the caller (one per thread).
+ *
+ * Returns:
+ * True if a solution was found; otherwise, false (the grid is then empty).
+ */
+static bool carve_random_solution(t_grid* g, int num_cells_to_fill, int* order, const atomic_bool* cancel, t_rng* rng) {
+    int cells = g->rows * g->cols;
+    solver_status_t status = SOLVER_NODE_LIMIT;
+    for (int attempt = 0; attempt < MAX_FILL_ATTEMPTS && status == SOLVER_NODE_LIMIT; attempt++) {
+        grid_reset(g);
+        t_solver solver;
+        solver_init(&solver, g);
+        solver_set_random(&solver, rng);
+        solver_set_cancel(&solver, cancel);
+        solver_set_limits(&solver, cells, 0);
+        status = solver_run(&solver);
+        solver_free(&solver);
+        LOG_INFO("Random solution, attempt %d: %s.\n", attempt + 1, status == SOLVER_SOLUTION ? "found" : "abandoned");
+    }
+    if (status != SOLVER_SOLUTION) {
+        grid_reset(g);
+        return false;
+    }
+
+    for (int i = 0; i < cells; i++) {
+        order[i] = i;
+    }
+    rng_shuffle(rng, order, cells);
+    for (int i = 0; i < cells - num_cells_to_fill; i++) {
+        grid_clear_cell(order[i] / g->cols, order[i] % g->cols, g);
+    }
+    return true;
+}
+
+
+/*
+ * Generates a random Takuzu grid with exactly the specified percentage of filled cells.
+ * Cells are visited once, in the order of a random permutation, and each one receives a
+ * value that keeps its row and column consistent (checked incrementally). A cell where no
+ * value fits is skipped, so an attempt is linear in the number of cells; if the
+ * permutation runs out before the wanted number of cells is filled, the grid is cleared
+ * and a new permutation is tried, up to MAX_FILL_ATTEMPTS times. High percentages (close
+ * to a full grid) are out of reach of this greedy fill: the grid is then carved out of a
+ * random solution instead.
  *
  * Parameters:
  * - g: Pointer to the Takuzu grid to be generated.
  * - percentage: Percentage of cells to be filled with '0' or '1'.
+ * - cancel: Flag that stops the generation once set (NULL: none).
+ * - rng: Random generator owned by the caller (one per thread).
  *
  * Returns:
- * The generated Takuzu grid.
- * If an error occurs, or the grid pointer is NULL, an error message may be displayed.
+ * True if exactly the requested number of cells was filled; otherwise, false
+ * (the size has no solution, none was found or the generation was cancelled, and
+ * there is no grid to print).
  */
-void generate_random_grid(t_grid* g, int percentage) {
+bool generate_random_grid(t_grid* g, int percentage, const atomic_bool* cancel, t_rng* rng) {
     if (g == NULL) {
         fprintf(stderr, "Error: Grid is NULL in generate_random_grid.\n");
-        return;
+        return false;
     }
 
-    // Initialize random number generator
-    srand(time(NULL));
-
     // Check if the percentage is valid
     if (percentage < 0 || percentage > 100) {
         fprintf(stderr, "Error: Invalid percentage value\n");
         exit(EXIT_FAILURE);
     }
 
-    grid_free(g);
-    grid_allocate(g, g->size);
-
-
-    int num_cells_to_fill = (percentage * g->size * g->size) / 100;
-
-    // Randomly place '0' and '1' cells
-    while (num_cells_to_fill > 0) {
-        int row = rand() % g->size;
-        int col = rand() % g->size;
+    int cells = g->rows * g->cols;
+    int num_cells_to_fill = (percentage * cells) / 100;
+    int* order = malloc(cells * sizeof(int));
+    if (order == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in generate_random_grid.\n");
+        exit(EXIT_FAILURE);
+    }
 
-        if (get_cell(row, col, g) == '_') {
-            char cell_value = place_cell_strategically(g, row, col);
-            set_cell(row, col, g, cell_value);
-            num_cells_to_fill--;
+    int filled = 0;
+    for (int attempt = 0; attempt < MAX_FILL_ATTEMPTS && filled < num_cells_to_fill; attempt++) {
+        grid_reset(g);
+        for (int i = 0; i < cells; i++) {
+            order[i] = i;
+        }
+        rng_shuffle(rng, order, cells);
+
+        // Randomly place '0' and '1' cells along the permutation
+        filled = 0;
+        for (int i = 0; i < cells && filled < num_cells_to_fill; i++) {
+            int row = order[i] / g->cols;
+            int col = order[i] % g->cols;
+            char cell_value = place_cell_strategically(g, row, col, rng);
+            if (cell_value != '_') {
+                grid_fill_cell(g, row, col, cell_value);
+                filled++;
+            }
         }
     }
+
+    bool generated = filled == num_cells_to_fill;
+    if (!generated) {
+        LOG_INFO("Only %d of %d cells could be filled, carving the grid out of a random solution.\n", filled, num_cells_to_fill);
+        generated = carve_random_solution(g, num_cells_to_fill, order, cancel, rng);
+    }
+    free(order);
+    return generated;
 }
 
 
-void generate_random_grid_with_solution(t_grid* g, int percentage) {
+/*
+ * Generates random Takuzu grids until one of them has at least one solution.
+ * The solvability test runs on a copy, so the returned grid is the puzzle itself
+ * and nothing is printed (the function can be used from several threads).
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid to be generated.
+ * - percentage: Percentage of cells to be filled with '0' or '1'.
+ * - cancel: Flag that stops the generation once set (NULL: none).
+ * - rng: Random generator owned by the caller (one per thread).
+ */
+bool generate_random_grid_with_solution(t_grid* g, int percentage, const atomic_bool* cancel, t_rng* rng) {
     if (g == NULL) {
         fprintf(stderr, "Error: Grid is NULL in generate_random_grid_with_solution.\n");
-        return;
+        return false;
     }
 
 
-    if (g->size == 8 || g->size == 4) { //We only do that for grid 4 or 8 because it's too long for 16,32 or 64
+    if (g->rows * g->cols <= 64) { //We only do that for grids up to 8x8 because it's too long for bigger ones
 
         // Max try
         int max_attempts = INT_MAX;
         int attempt_count = 0;
 
-        t_grid* solution = NULL;
+        bool solved = false;
+        t_grid attempt;
+        grid_allocate(&attempt, g->rows, g->cols);
 
         do {
-            generate_random_grid(g, percentage);
-
-            // Verify if the grid have one solution
-            solution = grid_solver(g, MODE_FIRST);
+            if (!generate_random_grid(g, percentage, cancel, rng)) {
+                break;  // The requested fill cannot be reached, give up
+            }
 
-            grid_free(solution);
+            // Verify if the grid have one solution, without touching the puzzle
+            t_solver solver;
+            grid_copy(g, &attempt);
+            solver_init(&solver, &attempt);
+            solved = solver_run(&solver) == SOLVER_SOLUTION;
+            solver_free(&solver);
 
             attempt_count++;
 
-        } while (solution == NULL && attempt_count < max_attempts);
+        } while (!solved && attempt_count < max_attempts);
 
-        if (solution == NULL) {
-            fprintf(stderr, "Error: Unable to generate a grid with at least one solution.\n");
+        grid_free(&attempt);
+        if (!solved) {
+            LOG_INFO("Error: Unable to generate a grid with at least one solution.\n");
+            return false;
         }
+        return true;
     }
     else {
-        generate_random_grid(g, percentage);
-
+        return generate_random_grid(g, percentage, cancel, rng);
     }
 }
 
@@ -962,8 +1538,8 @@ void grid_choice_apply(t_grid* grid, const choice_t choice) {
     }
 
     // Ensure the choice is within valid bounds
-    if (choice.row < 0 || choice.row >= grid->size ||
-        choice.column < 0 || choice.column >= grid->size) {
+    if (choice.row < 0 || choice.row >= grid->rows ||
+        choice.column < 0 || choice.column >= grid->cols) {
         fprintf(stderr, "Error: Invalid choice coordinates.\n");
         return;
     }
@@ -1007,7 +1583,7 @@ int count_empty_zeros_ones_in_row(int row, t_grid* grid, char value) {
         return false;
     }
     int count = 0;
-    for (int col = 0; col < grid->size; col++) {
+    for (int col = 0; col < grid->cols; col++) {
         if (get_cell(row, col, grid) == value) {
             count++;
         }
@@ -1024,7 +1600,7 @@ int count_empty_zeros_ones_in_column(int col, t_grid* grid, char value) {
         return false;
     }
     int count = 0;
-    for (int row = 0; row < grid->size; row++) {
+    for (int row = 0; row < grid->rows; row++) {
         if (get_cell(row, col, grid) == value) {
             count++;
         }
@@ -1041,7 +1617,7 @@ int count_zeros_ones_in_square(int start_row, int start_col, t_grid* grid, char
         return false;
     }
     int count = 0;
-    int square_size = (int)sqrt(grid->size);
+    int square_size = (int)sqrt(grid->rows < grid->cols ? grid->rows : grid->cols);
     for (int row = start_row; row < start_row + square_size; row++) {
         for (int col = start_col; col < start_col + square_size; col++) {
             if (get_cell(row, col, grid) == value) {
@@ -1069,7 +1645,7 @@ int count_choices_for_cell(int row, int col, t_grid* grid) {
     int zeros_in_col = count_empty_zeros_ones_in_column(col, grid, '0');
     int ones_in_col = count_empty_zeros_ones_in_column(col, grid, '1');
 
-    int square_size = (int)sqrt(grid->size);
+    int square_size = (int)sqrt(grid->rows < grid->cols ? grid->rows : grid->cols);
     int start_row = (row / square_size) * square_size;
     int start_col = (col / square_size) * square_size;
     int zeros_in_square = count_zeros_ones_in_square(start_row, start_col, grid, '0');
@@ -1092,8 +1668,8 @@ choice_t grid_choice_deterministic(t_grid* grid, char choice) {
 
     int min_choices = INT_MAX;
 
-    for (int row = 0; row < grid->size; row++) {
-        for (int col = 0; col < grid->size; col++) {
+    for (int row = 0; row < grid->rows; row++) {
+        for (int col = 0; col < grid->cols; col++) {
             if (get_cell(row, col, grid) == '_') {
                 int choices = count_choices_for_cell(row, col, grid);
                 if (choices < min_choices) {
@@ -1134,8 +1710,8 @@ choice_t grid_choice_ordered(t_grid* grid, char choice) {
     }
 
     // Traverse the grid to find the first empty cell
-    for (int row = 0; row < grid->size; row++) {
-        for (int col = 0; col < grid->size; col++) {
+    for (int row = 0; row < grid->rows; row++) {
+        for (int col = 0; col < grid->cols; col++) {
             if (get_cell(row, col, grid) == '_') {
                 best_choice.row = row;
                 best_choice.column = col;
@@ -1175,155 +1751,3 @@ bool grid_choice(t_grid* grid, char choice) {
     }
     return we_make_choice;
 }
-
-
-t_grid* grid_solver_backtracking(t_grid* grid, mode_t mode, int* solution_count) {
-    if (grid == NULL) {
-        fprintf(stderr, "Error: Grid is NULL in grid_solver_backtracking.\n");
-        return NULL;
-    }
-
-    if (is_valid(grid)) {
-        t_grid* solution = malloc(sizeof(t_grid));
-        if (solution == NULL) {
-            fprintf(stderr, "Error: Memory allocation failed for solution.\n");
-            exit(EXIT_FAILURE);
-        }
-        grid_allocate(solution, grid->size);
-        grid_copy(grid, solution);
-        (*solution_count)++;
-        return solution;  // Return the solved grid
-    }
-
-    if (!is_consistent(grid)) {
-        if (option.verbose) {
-            printf("The grid is inconsistent.\n");
-        }
-        return NULL;
-    }
-
-    // Application of heuristics
-    apply_heuristics_until_stable(grid);
-
-    if (is_valid(grid)) {
-        t_grid* solution = malloc(sizeof(t_grid));
-        if (solution == NULL) {
-            fprintf(stderr, "Error: Memory allocation failed for solution.\n");
-            exit(EXIT_FAILURE);
-        }
-        grid_allocate(solution, grid->size);
-        grid_copy(grid, solution);
-        (*solution_count)++;
-        return solution;  // Return the solved grid
-    }
-
-    // If the grid is inconsistent after applying heuristics, return NULL
-    if (!is_consistent(grid)) {
-        if (option.verbose) {
-            printf("The grid is inconsistent.\n");
-        }
-        return NULL;
-    }
-
-    t_grid original_grid;
-    grid_allocate(&original_grid, grid->size);
-    grid_copy(grid, &original_grid);
-
-    for (char choice = '0'; choice <= '1'; choice++) {
-        if (grid_choice(grid, choice)) {
-            t_grid* solution = grid_solver_backtracking(grid, mode, solution_count);
-            if (solution != NULL) {
-                // Return the solved grid
-                return solution;
-            }
-
-            // Backtracking must restore the original state
-            grid_copy(&original_grid, grid);
-        }
-    }
-
-    // Cleanup
-    grid_free(&original_grid);
-    return NULL;
-}
-
-
-
-void find_first_solution(t_grid* grid, const mode_t mode) {
-    int solution_count = 0;
-    t_grid* solution = grid_solver_backtracking(grid, mode, &solution_count);
-
-    if (solution != NULL) {
-        // Print the number of solutions
-        printf("Number of solutions: %d\n", solution_count);
-
-        // Print the first solution
-        printf("Solution 1\n");
-
-        // Cleanup
-        grid_free(solution);
-    }
-    else {
-        printf("No solution found.\n");
-    }
-}
-
-
-
-void find_all_solutions(t_grid* grid, const mode_t mode) {
-    int solution_count = 0;
-
-    // Reset the grid to its original state for further use if needed
-    t_grid original_grid;
-    grid_allocate(&original_grid, grid->size);
-    grid_copy(grid, &original_grid);
-
-    // Array to store solutions
-    t_grid* solutions[INT_MAX];
-
-    while (1) {
-        t_grid* solution = grid_solver_backtracking(grid, mode, &solution_count);
-        if (solution == NULL) {
-            break;  // No more solutions
-        }
-
-        solutions[solution_count - 1] = solution;
-    }
-
-    // Print the number of solutions
-    printf("Number of solutions: %d\n", solution_count);
-
-    // Print each solution
-    for (int i = 0; i < solution_count; ++i) {
-        printf("Solution %d\n", i + 1);
-        grid_print(solutions[i], stdout);
-        grid_free(solutions[i]);  // Free each solution
-    }
-
-    // Cleanup
-    grid_free(&original_grid);
-}
-
-
-
-
-
-t_grid* grid_solver(t_grid* grid, const mode_t mode) {
-    // Make a copy of the original grid to preserve the input
-    t_grid original_grid;
-    grid_allocate(&original_grid, grid->size);
-    grid_copy(grid, &original_grid);
-
-    // Call the solving function based on the mode
-    if (mode == MODE_FIRST) {
-        find_first_solution(grid, mode);
-    }
-    else if (mode == MODE_ALL) {
-        find_all_solutions(grid, mode);
-    }
-
-    // No need to return the modified grid since it's modified in place
-    // Return NULL or the original grid based on your needs
-    grid_free(&original_grid);
-    return grid;  // Returning the original grid or NULL based on your program logic
-}
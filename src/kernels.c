@@ -0,0 +1,185 @@
+#include "../include/kernels.h"
+#include "../include/swar8.h"
+#include "../include/avx64.h"
+
+
+/*
+ * Square grids of 4, 16, 32 and 64 cells per side get their own copy of the
+ * consistency check and of the propagation, stamped out by DEFINE_KERNELS. In each
+ * copy the size is a constant and a line is a single word of the matching width
+ * (uint8_t up to uint64_t), so the loops over the lines have a known trip count and
+ * unroll into straight-line code for the small sizes. 8x8 grids use the whole-board
+ * engine of swar8.c instead, and 64x64 grids the AVX2 engine of avx64.c when the
+ * processor has it. Other grids, and the verbose runs of the debug build that need
+ * the diagnostics of grid.c, use the generic functions of grid.c.
+ *
+ * The propagation applies the rules of apply_heuristics_once on whole lines at
+ * once: a pair of equal values forces the opposite value on both sides, two equal
+ * values around an empty cell force the opposite value in it, and a line holding
+ * half of its cells of one value is completed with the other value.
+ */
+
+// Loops over the lines are unrolled by this factor (fully for the small sizes)
+#define KERNEL_UNROLL _Pragma("GCC unroll 8")
+
+// Mask of the cells of a line of N cells, in the word type T
+#define KERNEL_MASK(N, T) ((T)((N) == 64 ? ~0ULL : (1ULL << ((N) % 64)) - 1))
+
+
+/*
+ * Fills an empty cell of a grid whose lines fit in one word, keeping the cells, the
+ * packed lines, the counts of empty cells, the sets of complete lines and the trail
+ * in sync like set_cell, without its checks.
+ *
+ * Parameters:
+ * - g: Pointer to the grid.
+ * - i: Row of the cell.
+ * - j: Column of the cell.
+ * - v: '0' or '1'.
+ */
+static inline void kernel_fill(t_grid* g, int i, int j, char v) {
+    int index = i * g->cols + j;
+    if (g->trail != NULL) {
+        g->trail[g->trail_length++] = index;
+    }
+    grid_write_cell(g, i, j, v);
+    g->row_filled[i] |= 1ULL << j;
+    g->col_filled[j] |= 1ULL << i;
+    if (v == '1') {
+        g->row_ones[i] |= 1ULL << j;
+        g->col_ones[j] |= 1ULL << i;
+    }
+    g->empty--;
+    if (--g->row_empty[i] == 0) {
+        lineset_insert(&g->full_rows, g->row_ones, 1, i);
+    }
+    if (--g->col_empty[j] == 0) {
+        lineset_insert(&g->full_cols, g->col_ones, 1, j);
+    }
+}
+
+
+/*
+ * Cells of a line forced to the opposite value by the cells holding a value:
+ * next to a pair of them, or between two of them.
+ *
+ * Parameters:
+ * - v: Cells of the line holding the value.
+ *
+ * Returns:
+ * The forced cells, possibly outside the line or already filled.
+ */
+static inline uint64_t kernel_forced(uint64_t v) {
+    uint64_t pairs = v & (v >> 1);
+    return (pairs << 2) | (pairs >> 1) | ((v << 1) & (v >> 1));
+}
+
+
+#define DEFINE_KERNELS(N, T)                                                            \
+static bool kernel_consistent_##N(t_grid* g) {                                          \
+    if (grid_has_identical_lines(g)) {                                                  \
+        return false;                                                                   \
+    }                                                                                   \
+    for (int pass = 0; pass < 2; pass++) {                                              \
+        const uint64_t* filled = (pass == 0) ? g->row_filled : g->col_filled;           \
+        const uint64_t* ones = (pass == 0) ? g->row_ones : g->col_ones;                 \
+        KERNEL_UNROLL                                                                   \
+        for (int line = 0; line < N; line++) {                                          \
+            T f = (T)filled[line];                                                      \
+            T o = (T)ones[line];                                                        \
+            T z = (T)(f & ~o);                                                          \
+            if (__builtin_popcountll(o) > N / 2 || __builtin_popcountll(z) > N / 2) {   \
+                return false;                                                           \
+            }                                                                           \
+            if ((T)(z & (z >> 1) & (z >> 2)) != 0 || (T)(o & (o >> 1) & (o >> 2)) != 0) { \
+                return false;                                                           \
+            }                                                                           \
+        }                                                                               \
+    }                                                                                   \
+    return true;                                                                        \
+}                                                                                       \
+                                                                                        \
+static bool kernel_propagate_##N(t_grid* g) {                                           \
+    const T mask = KERNEL_MASK(N, T);                                                   \
+    bool changed = false;                                                               \
+    for (int pass = 0; pass < 2; pass++) {                                              \
+        const uint64_t* filled = (pass == 0) ? g->row_filled : g->col_filled;           \
+        const uint64_t* ones = (pass == 0) ? g->row_ones : g->col_ones;                 \
+        KERNEL_UNROLL                                                                   \
+        for (int line = 0; line < N; line++) {                                          \
+            T f = (T)filled[line];                                                      \
+            T empty = (T)(~f & mask);                                                   \
+            if (empty == 0) {                                                           \
+                continue;                                                               \
+            }                                                                           \
+            T o = (T)ones[line];                                                        \
+            T z = (T)(f & ~o);                                                          \
+            T set_one = (T)(kernel_forced(z) & empty);                                  \
+            T set_zero = (T)(kernel_forced(o) & empty);                                 \
+            if (__builtin_popcountll(z) == N / 2) {                                     \
+                set_one = empty;                                                        \
+            }                                                                           \
+            else if (__builtin_popcountll(o) == N / 2) {                                \
+                set_zero = empty;                                                       \
+            }                                                                           \
+            set_zero = (T)(set_zero & ~set_one);                                        \
+            changed = changed || (set_one | set_zero) != 0;                             \
+            while (set_one != 0) {                                                      \
+                int cell = __builtin_ctzll(set_one);                                    \
+                set_one = (T)(set_one & (set_one - 1));                                 \
+                if (pass == 0) kernel_fill(g, line, cell, '1');                         \
+                else kernel_fill(g, cell, line, '1');                                   \
+            }                                                                           \
+            while (set_zero != 0) {                                                     \
+                int cell = __builtin_ctzll(set_zero);                                   \
+                set_zero = (T)(set_zero & (set_zero - 1));                              \
+                if (pass == 0) kernel_fill(g, line, cell, '0');                         \
+                else kernel_fill(g, cell, line, '0');                                   \
+            }                                                                           \
+        }                                                                               \
+    }                                                                                   \
+    return changed;                                                                     \
+}                                                                                       \
+                                                                                        \
+static const t_kernels kernels_##N = { N, kernel_consistent_##N, kernel_propagate_##N };
+
+DEFINE_KERNELS(4, uint8_t)
+DEFINE_KERNELS(16, uint16_t)
+DEFINE_KERNELS(32, uint32_t)
+DEFINE_KERNELS(64, uint64_t)
+
+static const t_kernels kernels_8 = { 8, swar8_consistent, swar8_propagate };
+
+static const t_kernels kernels_64_avx2 = { 64, avx64_consistent, avx64_propagate };
+
+const t_kernels kernels_generic = { 0, is_consistent, apply_heuristics_once };
+
+
+/*
+ * Chooses the kernels of a grid, once per puzzle.
+ *
+ * Parameters:
+ * - g: Pointer to the grid.
+ *
+ * Returns:
+ * The kernels specialized for the size of the grid, or the generic ones.
+ */
+const t_kernels* kernels_select(const t_grid* g) {
+    if ((LOG_LEVEL >= LOG_LEVEL_DEBUG && log_verbose) || g->rows != g->cols) {
+        return &kernels_generic;
+    }
+    switch (g->rows) {
+    case 4:
+        return &kernels_4;
+    case 8:
+        return &kernels_8;
+    case 16:
+        return &kernels_16;
+    case 32:
+        return &kernels_32;
+    case 64:
+        return avx64_supported() ? &kernels_64_avx2 : &kernels_64;
+    default:
+        return &kernels_generic;
+    }
+}
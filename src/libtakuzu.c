@@ -0,0 +1,503 @@
+#include "../include/libtakuzu.h"
+#include "../include/takuzu.h"
+#include "../include/grid.h"
+#include "../include/batch.h"
+#include "../include/rating.h"
+#include "../include/solver.h"
+#include "../include/schedule.h"
+#include "../include/probe.h"
+
+
+/*
+ * The library is a thin layer over the engine. The settings of a context are a
+ * takuzu_Options, handed to the engine like the command line does, and the verbose
+ * mode of the engine is the thread-local log_verbose, set from the context for the
+ * duration of each call.
+ */
+
+
+// Context of the library
+struct tk_ctx {
+    takuzu_Options options;     // Settings of the calls, with the defaults of the command line
+    t_grid grid;                // Current grid (grid.grid is NULL until one is parsed or generated)
+    atomic_bool cancel;         // Set by tk_cancel, the flag of options.cancel
+};
+
+// Iterator of the library: an enumeration of the engine over its own grid
+struct tk_iter {
+    t_grid grid;                // Copy of the grid of the context, searched in place
+    takuzu_Options options;     // Settings of the context when the iterator was created
+    atomic_bool cancel;         // Set by tk_iter_cancel, the flag of options.cancel
+    t_solution_iter solutions;
+};
+
+// Callback of the library in an enumeration
+typedef struct {
+    tk_solution_fn callback;
+    void* data;
+} t_tk_enumeration;
+
+// Names of the results, in the order of tk_status
+static const char* tk_status_names[] = {
+    "ok", "no solution", "invalid argument", "parse error", "no grid", "inconsistent grid", "generation failed",
+    "unknown (budget exhausted)", "unknown (cancelled)"
+};
+
+
+/*
+ * Sets the verbose mode of the calling thread to the one of the settings of a call.
+ *
+ * Returns:
+ * The previous verbose mode, given back to tk_leave.
+ */
+static bool tk_enter(const takuzu_Options* options) {
+    bool previous = log_verbose;
+    log_verbose = options->verbose;
+    return previous;
+}
+
+
+static void tk_leave(bool previous) {
+    log_verbose = previous;
+}
+
+
+/*
+ * Result of a search stopped by its budget (see solver_stopped).
+ */
+static tk_status tk_stopped(solver_status_t status) {
+    return (status == SOLVER_CANCELLED) ? TK_CANCELLED : TK_BUDGET_EXHAUSTED;
+}
+
+
+/*
+ * Creates a context with the default settings of the command line and no grid.
+ *
+ * Returns:
+ * The context, or NULL if memory allocation failed.
+ */
+tk_ctx* tk_ctx_new(void) {
+    tk_ctx* ctx = (tk_ctx*)calloc(1, sizeof(tk_ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    initializeTakuzuOptions(&ctx->options);
+    atomic_init(&ctx->cancel, false);
+    ctx->options.cancel = &ctx->cancel;
+    return ctx;
+}
+
+
+/*
+ * Frees a context and its grid.
+ *
+ * Parameters:
+ * - ctx: Context, or NULL.
+ */
+void tk_ctx_free(tk_ctx* ctx) {
+    if (ctx == NULL) {
+        return;
+    }
+    grid_free(&ctx->grid);
+    free(ctx);
+}
+
+
+/*
+ * Enables or disables the verbose messages of the calls of a context, on stderr.
+ *
+ * Parameters:
+ * - ctx: Context.
+ * - verbose: true for the messages of takuzu -v.
+ */
+void tk_set_verbose(tk_ctx* ctx, bool verbose) {
+    if (ctx != NULL) {
+        ctx->options.verbose = verbose;
+    }
+}
+
+
+/*
+ * Sets the propagation of the solver, as -L, -p and -P: a probing depth alone selects
+ * the probe tier, and the probe tier alone probes one level deep.
+ *
+ * Parameters:
+ * - ctx: Context.
+ * - level: "basic", "lines" or "probe", NULL to keep the current level.
+ * - probe_depth: Nesting of the probes, 0 to PROBE_MAX_DEPTH.
+ * - probe_budget: Values probed per node and per round (0: no limit).
+ *
+ * Returns:
+ * TK_OK, or TK_ERROR_ARGUMENT if a setting is invalid (the context is then unchanged).
+ */
+tk_status tk_set_propagation(tk_ctx* ctx, const char* level, int probe_depth, long probe_budget) {
+    if (ctx == NULL || probe_depth < 0 || probe_depth > PROBE_MAX_DEPTH || probe_budget < 0) {
+        return TK_ERROR_ARGUMENT;
+    }
+    tier_t tier = ctx->options.propagation;
+    if (level != NULL && !parse_propagation(level, &tier)) {
+        return TK_ERROR_ARGUMENT;
+    }
+    if (level == NULL && probe_depth > 0) {
+        tier = TIER_PROBE;
+    }
+    if (tier == TIER_PROBE && probe_depth == 0) {
+        probe_depth = 1;
+    }
+    if (tier != TIER_PROBE) {
+        probe_depth = 0;
+    }
+    ctx->options.propagation = tier;
+    ctx->options.probe_depth = probe_depth;
+    ctx->options.probe_budget = probe_budget;
+    return TK_OK;
+}
+
+
+/*
+ * Sets the budget of each solve, count and iterator of a context, as --max-nodes and
+ * --timeout-ms.
+ *
+ * Parameters:
+ * - ctx: Context.
+ * - max_nodes: Nodes a search may propagate (0: no limit).
+ * - timeout_ms: Time a search may take, in milliseconds (0: no limit).
+ *
+ * Returns:
+ * TK_OK, or TK_ERROR_ARGUMENT if a setting is invalid (the context is then unchanged).
+ */
+tk_status tk_set_limits(tk_ctx* ctx, uint64_t max_nodes, long timeout_ms) {
+    if (ctx == NULL || timeout_ms < 0) {
+        return TK_ERROR_ARGUMENT;
+    }
+    ctx->options.max_nodes = max_nodes;
+    ctx->options.timeout_ms = timeout_ms;
+    return TK_OK;
+}
+
+
+/*
+ * Stops the search or the generation running on a context. The flag is cleared when
+ * the next call of the context starts, and the search reads it every few hundred nodes.
+ *
+ * Parameters:
+ * - ctx: Context, or NULL.
+ */
+void tk_cancel(tk_ctx* ctx) {
+    if (ctx != NULL) {
+        atomic_store(&ctx->cancel, true);
+    }
+}
+
+
+/*
+ * Parses a grid, written as in a grid file, into the context.
+ *
+ * Parameters:
+ * - ctx: Context, whose previous grid is replaced.
+ * - text: The grid: rows of '0', '1' and '_', comments marked with '#'.
+ *
+ * Returns:
+ * TK_OK, TK_ERROR_PARSE if the text holds no valid grid, or TK_ERROR_ARGUMENT.
+ */
+tk_status tk_parse(tk_ctx* ctx, const char* text) {
+    if (ctx == NULL || text == NULL) {
+        return TK_ERROR_ARGUMENT;
+    }
+    size_t length = strlen(text);
+    if (length == 0) {
+        return TK_ERROR_PARSE;
+    }
+    FILE* file = fmemopen((void*)text, length, "r");
+    if (file == NULL) {
+        return TK_ERROR_PARSE;
+    }
+
+    bool previous = tk_enter(&ctx->options);
+    t_grid_reader reader;
+    t_grid grid;
+    grid_reader_attach(&reader, file, false);
+    int read = grid_read(&reader, &grid);
+    grid_reader_close(&reader);
+    tk_leave(previous);
+    if (read != EXIT_SUCCESS) {
+        return TK_ERROR_PARSE;
+    }
+
+    grid_free(&ctx->grid);
+    ctx->grid = grid;
+    return TK_OK;
+}
+
+
+/*
+ * Generates a grid into the context, as takuzu -g does for the grid of the same index.
+ *
+ * Parameters:
+ * - ctx: Context, whose previous grid is replaced.
+ * - options: Settings of the generation.
+ *
+ * Returns:
+ * TK_OK, TK_ERROR_GENERATION if the cells could not be filled (the context then
+ * holds the partial grid), TK_CANCELLED, or TK_ERROR_ARGUMENT.
+ */
+tk_status tk_generate(tk_ctx* ctx, const tk_generate_options* options) {
+    if (ctx == NULL || options == NULL || !is_valid_grid_size(options->rows) || !is_valid_grid_size(options->cols) ||
+        options->percentage < 0 || options->percentage > 100) {
+        return TK_ERROR_ARGUMENT;
+    }
+    takuzu_Options generation = ctx->options;
+    generation.grid_rows = options->rows;
+    generation.grid_cols = options->cols;
+    generation.number = options->percentage;
+    generation.unique = options->solvable;
+    generation.difficulty_given = (options->difficulty != NULL);
+    if (generation.difficulty_given && !parse_difficulty(options->difficulty, &generation.difficulty)) {
+        return TK_ERROR_ARGUMENT;
+    }
+
+    atomic_store(&ctx->cancel, false);
+    bool previous = tk_enter(&ctx->options);
+    grid_free(&ctx->grid);
+    grid_allocate(&ctx->grid, options->rows, options->cols);
+    t_rng rng;
+    rng_seed(&rng, options->seed, options->index);
+    bool generated = generate_grid(&ctx->grid, &generation, &rng);
+    tk_leave(previous);
+    if (!generated && atomic_load(&ctx->cancel)) {
+        return TK_CANCELLED;
+    }
+    return generated ? TK_OK : TK_ERROR_GENERATION;
+}
+
+
+/*
+ * Dimensions and cells of the grid of a context.
+ *
+ * Returns:
+ * The number of rows or columns (0 without a grid), or the rows x cols cells row by
+ * row, not terminated (NULL without a grid). The cells change with the next call.
+ */
+int tk_rows(const tk_ctx* ctx) {
+    return (ctx == NULL || ctx->grid.grid == NULL) ? 0 : ctx->grid.rows;
+}
+
+
+int tk_cols(const tk_ctx* ctx) {
+    return (ctx == NULL || ctx->grid.grid == NULL) ? 0 : ctx->grid.cols;
+}
+
+
+const char* tk_cells(const tk_ctx* ctx) {
+    return (ctx == NULL) ? NULL : ctx->grid.grid;
+}
+
+
+/*
+ * Checks that a context holds a consistent grid, before solving it.
+ */
+static tk_status tk_check_grid(tk_ctx* ctx) {
+    if (ctx->grid.grid == NULL) {
+        return TK_ERROR_NO_GRID;
+    }
+    return is_consistent(&ctx->grid) ? TK_OK : TK_ERROR_INCONSISTENT;
+}
+
+
+/*
+ * Hands a solution of solve_all to the callback of the library.
+ */
+static bool tk_solution(const t_grid* solution, uint64_t index, void* data) {
+    t_tk_enumeration* enumeration = (t_tk_enumeration*)data;
+    return enumeration->callback(solution->grid, solution->rows, solution->cols, index, enumeration->data);
+}
+
+
+/*
+ * Solves the grid of a context. Without a callback, the search stops at the first
+ * solution, which replaces the grid; with one, every solution is handed to it, and
+ * the grid keeps the first one. Without solution, the grid is left unchanged.
+ *
+ * Parameters:
+ * - ctx: Context holding a grid.
+ * - callback: Called with each solution, NULL for the first solution only.
+ * - data: Passed to the callback.
+ * - count: Receives the number of solutions (up to the one that stopped the
+ *   enumeration, or found before the budget stopped it), may be NULL.
+ *
+ * Returns:
+ * TK_OK, TK_NO_SOLUTION, TK_BUDGET_EXHAUSTED, TK_CANCELLED, TK_ERROR_NO_GRID,
+ * TK_ERROR_INCONSISTENT or TK_ERROR_ARGUMENT.
+ */
+tk_status tk_solve(tk_ctx* ctx, tk_solution_fn callback, void* data, uint64_t* count) {
+    if (ctx == NULL) {
+        return TK_ERROR_ARGUMENT;
+    }
+    atomic_store(&ctx->cancel, false);
+    bool previous = tk_enter(&ctx->options);
+    tk_status status = tk_check_grid(ctx);
+    uint64_t solutions = 0;
+    if (status == TK_OK) {
+        // A search without solution leaves the cells deduced at its root, so the grid is saved
+        t_grid saved;
+        grid_allocate(&saved, ctx->grid.rows, ctx->grid.cols);
+        grid_copy(&ctx->grid, &saved);
+        t_solve_stats stats;
+        if (callback == NULL) {
+            solutions = solve_first(&ctx->grid, &ctx->options, &stats) ? 1 : 0;
+        }
+        else {
+            t_tk_enumeration enumeration = { callback, data };
+            solutions = solve_all(&ctx->grid, &ctx->options, tk_solution, &enumeration, &stats);
+        }
+        if (solutions == 0) {
+            grid_copy(&saved, &ctx->grid);
+            status = TK_NO_SOLUTION;
+        }
+        if (solver_stopped(stats.status)) {
+            status = tk_stopped(stats.status);
+        }
+        grid_free(&saved);
+    }
+    tk_leave(previous);
+    if (count != NULL) {
+        *count = solutions;
+    }
+    return status;
+}
+
+
+/*
+ * Counts the solutions of the grid of a context without enumerating them, as takuzu -A.
+ *
+ * Parameters:
+ * - ctx: Context holding a grid, left unchanged.
+ * - count: Receives the number of solutions (a lower bound if the budget stopped the count).
+ *
+ * Returns:
+ * TK_OK (also for 0 solutions), TK_BUDGET_EXHAUSTED, TK_CANCELLED, TK_ERROR_NO_GRID,
+ * TK_ERROR_INCONSISTENT or TK_ERROR_ARGUMENT.
+ */
+tk_status tk_count(tk_ctx* ctx, uint64_t* count) {
+    if (ctx == NULL || count == NULL) {
+        return TK_ERROR_ARGUMENT;
+    }
+    atomic_store(&ctx->cancel, false);
+    bool previous = tk_enter(&ctx->options);
+    tk_status status = tk_check_grid(ctx);
+    *count = 0;
+    if (status == TK_OK) {
+        t_solve_stats stats;
+        *count = solve_count(&ctx->grid, &ctx->options, &stats);
+        if (solver_stopped(stats.status)) {
+            status = tk_stopped(stats.status);
+        }
+    }
+    tk_leave(previous);
+    return status;
+}
+
+
+/*
+ * Creates an iterator over the solutions of the grid of a context.
+ *
+ * Parameters:
+ * - ctx: Context holding a grid, left unchanged.
+ * - iter: Receives the iterator, NULL on error.
+ *
+ * Returns:
+ * TK_OK, TK_ERROR_NO_GRID, TK_ERROR_INCONSISTENT or TK_ERROR_ARGUMENT.
+ */
+tk_status tk_iter_new(tk_ctx* ctx, tk_iter_t** iter) {
+    if (ctx == NULL || iter == NULL) {
+        return TK_ERROR_ARGUMENT;
+    }
+    *iter = NULL;
+    bool previous = tk_enter(&ctx->options);
+    tk_status status = tk_check_grid(ctx);
+    if (status == TK_OK) {
+        tk_iter_t* created = (tk_iter_t*)malloc(sizeof(tk_iter_t));
+        if (created == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed in tk_iter_new.\n");
+            exit(EXIT_FAILURE);
+        }
+        created->options = ctx->options;
+        atomic_init(&created->cancel, false);
+        created->options.cancel = &created->cancel;
+        grid_allocate(&created->grid, ctx->grid.rows, ctx->grid.cols);
+        grid_copy(&ctx->grid, &created->grid);
+        solution_iter_init(&created->solutions, &created->grid, &created->options);
+        *iter = created;
+    }
+    tk_leave(previous);
+    return status;
+}
+
+
+/*
+ * Resumes the search of an iterator up to its next solution.
+ *
+ * Parameters:
+ * - iter: Iterator.
+ * - out_grid: Receives the rows x cols cells of the solution, row by row (may be NULL).
+ *
+ * Returns:
+ * TK_OK, TK_NO_SOLUTION once every solution was returned, TK_BUDGET_EXHAUSTED or
+ * TK_CANCELLED when the search stopped (for every later call too), or TK_ERROR_ARGUMENT.
+ */
+tk_status tk_iter_next(tk_iter_t* iter, char* out_grid) {
+    if (iter == NULL) {
+        return TK_ERROR_ARGUMENT;
+    }
+    bool previous = tk_enter(&iter->options);
+    const t_grid* solution = solution_iter_next(&iter->solutions);
+    tk_leave(previous);
+    if (solution == NULL) {
+        return solver_stopped(iter->solutions.status) ? tk_stopped(iter->solutions.status) : TK_NO_SOLUTION;
+    }
+    if (out_grid != NULL) {
+        memcpy(out_grid, solution->grid, (size_t)solution->rows * solution->cols);
+    }
+    return TK_OK;
+}
+
+
+/*
+ * Stops the search of an iterator, from any thread. The search reads the flag every
+ * few hundred nodes; once it stopped, tk_iter_next returns TK_CANCELLED for good.
+ *
+ * Parameters:
+ * - iter: Iterator, or NULL.
+ */
+void tk_iter_cancel(tk_iter_t* iter) {
+    if (iter != NULL) {
+        atomic_store(&iter->cancel, true);
+    }
+}
+
+
+/*
+ * Frees an iterator, which may be left before its last solution.
+ *
+ * Parameters:
+ * - iter: Iterator, or NULL.
+ */
+void tk_iter_free(tk_iter_t* iter) {
+    if (iter == NULL) {
+        return;
+    }
+    solution_iter_free(&iter->solutions);
+    grid_free(&iter->grid);
+    free(iter);
+}
+
+
+/*
+ * Name of a result, for messages.
+ */
+const char* tk_status_name(tk_status status) {
+    if ((int)status < 0 || (int)status >= (int)(sizeof(tk_status_names) / sizeof(tk_status_names[0]))) {
+        return "unknown";
+    }
+    return tk_status_names[status];
+}
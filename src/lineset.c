@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../include/lineset.h"
+#include "../include/bitline.h"
+
+
+/*
+ * A line set follows the complete rows (or columns) of a grid as cells are filled
+ * and emptied: a line enters the set when its last cell is filled and leaves it
+ * before one of its cells is emptied. Equal lines hash to the same slot, so they
+ * sit in the same cluster of the table, and an insertion or a removal only scans
+ * that cluster to keep the number of duplicates up to date. The grid then knows
+ * whether two complete lines are identical without comparing any lines.
+ */
+
+
+/*
+ * Hashes the packed 'ones' bitset of a line.
+ */
+static inline uint64_t lineset_hash(const uint64_t* bits, int words) {
+    uint64_t hash = 0x9E3779B97F4A7C15ULL;
+    for (int w = 0; w < words; w++) {
+        hash = (hash ^ bits[w]) * 0xBF58476D1CE4E5B9ULL;
+        hash ^= hash >> 31;
+    }
+    return hash;
+}
+
+
+/*
+ * Gives the slot a line hashes to.
+ */
+static inline int lineset_home(const t_lineset* set, const uint64_t* ones, int words, int line) {
+    return (int)(lineset_hash(ones + (size_t)line * words, words) & (uint64_t)set->mask);
+}
+
+
+/*
+ * Tells whether the cluster starting at a slot holds a line, other than 'skip', whose
+ * bits are the given ones.
+ */
+static bool lineset_has_equal(const t_lineset* set, const uint64_t* ones, int words, const uint64_t* bits, int skip, int slot) {
+    for (; set->slots[slot] != -1; slot = (slot + 1) & set->mask) {
+        if (set->slots[slot] != skip && line_equal(ones + (size_t)set->slots[slot] * words, bits, words)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/*
+ * Allocates an empty line set with at least twice as many slots as lines.
+ *
+ * Parameters:
+ * - set: Pointer to the set to initialize.
+ * - lines: Number of lines of the grid in this direction.
+ */
+void lineset_init(t_lineset* set, int lines) {
+    int slots = 2;
+    while (slots < 2 * lines) {
+        slots *= 2;
+    }
+
+    set->slots = (int*)malloc(slots * sizeof(int));
+    if (set->slots == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in lineset_init.\n");
+        exit(EXIT_FAILURE);
+    }
+    set->mask = slots - 1;
+    lineset_clear(set);
+}
+
+
+/*
+ * Frees the slots of a line set.
+ *
+ * Parameters:
+ * - set: Pointer to the set.
+ */
+void lineset_free(t_lineset* set) {
+    free(set->slots);
+    set->slots = NULL;
+    set->mask = 0;
+    set->count = 0;
+    set->duplicates = 0;
+}
+
+
+/*
+ * Empties a line set.
+ *
+ * Parameters:
+ * - set: Pointer to the set.
+ */
+void lineset_clear(t_lineset* set) {
+    for (int slot = 0; slot <= set->mask; slot++) {
+        set->slots[slot] = -1;
+    }
+    set->count = 0;
+    set->duplicates = 0;
+}
+
+
+/*
+ * Adds a line that just became complete.
+ *
+ * Parameters:
+ * - set: Pointer to the set.
+ * - ones: Packed 'ones' bitsets of all the lines of this direction.
+ * - words: Number of words of a line.
+ * - line: Index of the complete line, not in the set.
+ */
+void lineset_insert(t_lineset* set, const uint64_t* ones, int words, int line) {
+    int slot = lineset_home(set, ones, words, line);
+    if (lineset_has_equal(set, ones, words, ones + (size_t)line * words, line, slot)) {
+        set->duplicates++;
+    }
+    while (set->slots[slot] != -1) {
+        slot = (slot + 1) & set->mask;
+    }
+    set->slots[slot] = line;
+    set->count++;
+}
+
+
+/*
+ * Removes a complete line, before one of its cells is emptied. The entries after it
+ * in its cluster are shifted back so that no probe stops early.
+ *
+ * Parameters:
+ * - set: Pointer to the set.
+ * - ones: Packed 'ones' bitsets of all the lines of this direction.
+ * - words: Number of words of a line.
+ * - line: Index of the line, in the set and still complete.
+ */
+void lineset_remove(t_lineset* set, const uint64_t* ones, int words, int line) {
+    int home = lineset_home(set, ones, words, line);
+    int hole = home;
+    while (set->slots[hole] != line) {
+        hole = (hole + 1) & set->mask;
+    }
+
+    for (int next = (hole + 1) & set->mask; set->slots[next] != -1; next = (next + 1) & set->mask) {
+        // An entry can fill the hole if its own slot is not between the hole and it
+        int slot = lineset_home(set, ones, words, set->slots[next]);
+        if (((next - slot) & set->mask) >= ((next - hole) & set->mask)) {
+            set->slots[hole] = set->slots[next];
+            hole = next;
+        }
+    }
+    set->slots[hole] = -1;
+    set->count--;
+
+    if (lineset_has_equal(set, ones, words, ones + (size_t)line * words, line, home)) {
+        set->duplicates--;
+    }
+}
+
+
+/*
+ * Tells whether the set holds a line with the given bits, which need not be a line
+ * of the grid.
+ *
+ * Parameters:
+ * - set: Pointer to the set.
+ * - ones: Packed 'ones' bitsets of all the lines of this direction.
+ * - words: Number of words of a line.
+ * - bits: Packed 'ones' bitset of a complete line.
+ *
+ * Returns:
+ * true if a line of the set is equal to it, false otherwise.
+ */
+bool lineset_contains(const t_lineset* set, const uint64_t* ones, int words, const uint64_t* bits) {
+    int slot = (int)(lineset_hash(bits, words) & (uint64_t)set->mask);
+    return lineset_has_equal(set, ones, words, bits, -1, slot);
+}
@@ -0,0 +1,5 @@
+#include "../include/log.h"
+
+
+// Verbose mode of the calling thread (see log.h)
+_Thread_local bool log_verbose = false;
@@ -0,0 +1,595 @@
+#include <signal.h>
+
+#include "../include/takuzu.h"
+#include "../include/grid.h"
+#include "../include/batch.h"
+#include "../include/rating.h"
+#include "../include/solver.h"
+#include "../include/schedule.h"
+#include "../include/checkpoint.h"
+
+
+// Long options without a short form
+enum {
+    OPTION_MAX_NODES = 256,
+    OPTION_TIMEOUT_MS,
+    OPTION_CHECKPOINT,
+    OPTION_RESUME
+};
+
+
+/*
+ * Function: parse_grid_dimensions
+ * -------------------------------
+ * Parses the size given to --generate: "N" for a square grid, "RxC" for R rows and C columns.
+ *
+ * Parameters:
+ *   - text: The size argument.
+ *   - rows: Pointer where the number of rows is stored.
+ *   - cols: Pointer where the number of columns is stored.
+ *
+ * Returns:
+ *   - true if both dimensions are valid grid sizes, false otherwise.
+ */
+static bool parse_grid_dimensions(const char* text, int* rows, int* cols) {
+    char* end;
+    long r = strtol(text, &end, 10);
+    long c = r;
+    if (end == text) {
+        return false;
+    }
+    if (*end == 'x' || *end == 'X') {
+        const char* second = end + 1;
+        c = strtol(second, &end, 10);
+        if (end == second) {
+            return false;
+        }
+    }
+    if (*end != '\0' || r > MAX_GRID_SIZE || c > MAX_GRID_SIZE ||
+        !is_valid_grid_size((int)r) || !is_valid_grid_size((int)c)) {
+        return false;
+    }
+    *rows = (int)r;
+    *cols = (int)c;
+    return true;
+}
+
+
+/*
+ * Function: print_usage
+ * ---------------------
+ * Print the usage information for the Takuzu program.
+ */
+void print_usage() {
+    printf("\nUsage: takuzu [-a|-A|-C|-r|-b|-L LEVEL|-p DEPTH|-P N|--max-nodes N|--timeout-ms MS|--checkpoint FILE|--resume FILE|-o FILE|-v|-h] FILE\n");
+    printf("takuzu -g[N|RxC] [-u|-d LEVEL|-o FILE|-v|-N|-c K|-j T|-s SEED|-h]\n");
+    printf("Solve or generate takuzu grids of any even size: 4, 6, 8, 10, ..., %d\n", MAX_GRID_SIZE);
+    printf("-a, --all search for all possible solutions\n");
+    printf("-A, --count-all count all possible solutions without printing them\n");
+    printf("-C, --count-dp count all possible solutions row by row, for nearly empty grids\n");
+    printf("-g[N|RxC], --generate[=N|RxC] generate a grid of size NxN or of R rows and C columns (default: 8)\n");
+    printf("-o FILE, --output FILE write output to FILE\n");
+    printf("-u, --unique generate a grid with a unique solution\n");
+    printf("-v, --verbose verbose output\n");
+    printf("-n, --number%% to set the percentage of '0' and '1' characters in the grid (default: 50%%)\n");
+    printf("-c K, --count K generate K grids, separated by a blank line (default: 1)\n");
+    printf("-j T, --jobs T generate the grids on T threads (default: 1)\n");
+    printf("-s SEED, --seed SEED seed of the random generator, for reproducible grids\n");
+    printf("-r, --rate rate the difficulty of the grid instead of solving it\n");
+    printf("-d LEVEL, --difficulty LEVEL generate grids of difficulty easy, medium or hard\n");
+    printf("-b, --batch FILE holds several grids separated by a blank line, FILE '-' reads the standard input\n");
+    printf("-L LEVEL, --propagation LEVEL propagate each search node with the rules up to basic, lines or probe (default: lines)\n");
+    printf("-p DEPTH, --probe DEPTH probe the empty cells of each search node, probes nested DEPTH deep, implies -L probe (1 to %d, default: 1 with -L probe, 0 otherwise)\n", PROBE_MAX_DEPTH);
+    printf("-P N, --probe-budget N try at most N values per node and per round of probing (default: 0, no limit)\n");
+    printf("--max-nodes N stop the search of each grid after N nodes, its result is then unknown (default: 0, no limit)\n");
+    printf("--timeout-ms MS stop the search of each grid after MS milliseconds, its result is then unknown (default: 0, no limit)\n");
+    printf("--checkpoint FILE with -a or -A, save the search to FILE every %d s and when it stops\n", CHECKPOINT_INTERVAL_MS / 1000);
+    printf("--resume FILE with -a or -A, resume the search saved in FILE and keep saving it there\n");
+    printf("-h, --help display this help and exit\n");
+}
+
+
+/*
+ * Function: output_to_file
+ * ------------------------
+ * Write the given content to the specified file.
+ *
+ * Parameters:
+ *   - filename: The name of the file to write to.
+ *   - content: The content to write to the file.
+ */
+void output_to_file(const char* filename, const char* content) {
+    FILE* file = fopen(filename, "w");
+    if (file == NULL) {
+        perror("Erreur lors de l'ouverture du fichier de sortie");
+        exit(EXIT_FAILURE);
+    }
+    fputs(content, file);
+    fclose(file);
+}
+
+
+takuzu_Options option; //variable for options
+
+static atomic_bool interrupted; // Set by SIGINT and SIGTERM, the cancellation flag of the solves
+
+static volatile sig_atomic_t interrupt_signal; // Signal that set interrupted
+
+
+/*
+ * Function: on_interrupt
+ * ----------------------
+ * Handler of SIGINT and SIGTERM: stops the running search, which prints what it found
+ * so far (and saves it with --checkpoint). The search reads the flag every few hundred
+ * nodes, so it stops at once; a repeated signal (e.g. sent to the whole process group
+ * by timeout) does not kill it before it is saved.
+ */
+static void on_interrupt(int signum) {
+    interrupt_signal = signum;
+    atomic_store(&interrupted, true);
+}
+
+
+/*
+ * Function: process_grid
+ * ----------------------
+ * Rates or solves one parsed grid and writes the result.
+ *
+ * Parameters:
+ *   - grid: Pointer to the parsed grid, solved in place.
+ *   - file: File stream where the result is written.
+ *
+ * Returns:
+ *   - EXIT_SUCCESS if the grid was handled, EXIT_FAILURE if it is not consistent, its
+ *     checkpoint cannot be resumed, or its search was stopped by --max-nodes,
+ *     --timeout-ms, SIGINT or SIGTERM.
+ *
+ * Notes:
+ *   - An inconsistent grid is written unchanged in batch mode, so that the output keeps
+ *     one entry per input grid.
+ */
+static int process_grid(t_grid* grid, FILE* file) {
+    if (option.rate) {
+        // Rate the grid with every tier, without solving it
+        t_rating rating;
+        rate_grid(grid, TIER_PROBE, &rating);
+        rating_print(&rating, file);
+        return rating.conflict ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    if (!is_consistent(grid)) {
+        fprintf(stderr, "The grid is not consistent.\n");
+        if (option.batch) {
+            grid_print(grid, file);
+        }
+        return EXIT_FAILURE;
+    }
+    if (is_valid(grid)) {
+        printf("The grid is already valid.\n");
+        grid_print(grid, file);
+        return EXIT_SUCCESS;
+    }
+
+    // A resumed search must be the one of this grid
+    t_checkpoint checkpoint;
+    if (option.resume_file != NULL) {
+        if (!checkpoint_read(option.resume_file, &checkpoint)) {
+            return EXIT_FAILURE;
+        }
+        if (!checkpoint_matches(&checkpoint, grid, &option)) {
+            checkpoint_free(&checkpoint);
+            return EXIT_FAILURE;
+        }
+        option.resume = &checkpoint;
+    }
+    t_solve_stats stats;
+    grid_solver(grid, &option, &stats);
+    solver_status_t status = stats.status;
+    if (option.resume_file != NULL) {
+        option.resume = NULL;
+        checkpoint_free(&checkpoint);
+    }
+    // Only a search whose last save succeeded can be resumed from where it stopped
+    if (option.checkpoint_file != NULL && solver_stopped(status)) {
+        if (stats.saved) {
+            fprintf(stderr, "The search is saved in '%s', resume it with --resume.\n", option.checkpoint_file);
+        }
+        else {
+            fprintf(stderr, "The search could not be saved in '%s'.\n", option.checkpoint_file);
+        }
+    }
+    if (option.mode == MODE_COUNT || option.mode == MODE_COUNT_DP) {
+        return solver_stopped(status) ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    if (solver_stopped(status)) {
+        // The result is unknown: as for an inconsistent grid, the grid is written unchanged in batch mode
+        if (option.batch) {
+            grid_print(grid, file);
+        }
+        return EXIT_FAILURE;
+    }
+    grid_print(grid, file);
+    if (option.verbose && file == stdout && is_consistent(grid)) {
+        printf("You activate Verbose, don't panic the grid is consistent\n");
+    }
+    return EXIT_SUCCESS;
+}
+
+
+/*
+ * Function: main
+ * --------------
+ *
+ * Parameters:
+ *   - argc: The number of command-line arguments.
+ *   - argv: An array of strings representing the command-line arguments.
+ *
+ * Returns:
+ *   - int: The exit status of the program.
+ *
+ * Notes:
+ *   - Use -h for more informations
+ */
+int main(int argc, char* argv[]) {
+    int c;
+    int option_index = 0;
+
+    initializeTakuzuOptions(&option);
+
+    static struct option long_options[] = {
+        {"all", no_argument, 0, 'a'},
+        {"count-all", no_argument, 0, 'A'},
+        {"count-dp", no_argument, 0, 'C'},
+        {"generate", optional_argument, 0, 'g'},
+        {"unique", no_argument, 0, 'u'},
+        {"verbose", no_argument, 0, 'v'},
+        {"output", required_argument, 0, 'o'},
+        {"number", optional_argument, 0, 'n'},
+        {"count", required_argument, 0, 'c'},
+        {"jobs", required_argument, 0, 'j'},
+        {"seed", required_argument, 0, 's'},
+        {"rate", no_argument, 0, 'r'},
+        {"difficulty", required_argument, 0, 'd'},
+        {"batch", no_argument, 0, 'b'},
+        {"propagation", required_argument, 0, 'L'},
+        {"probe", required_argument, 0, 'p'},
+        {"probe-budget", required_argument, 0, 'P'},
+        {"max-nodes", required_argument, 0, OPTION_MAX_NODES},
+        {"timeout-ms", required_argument, 0, OPTION_TIMEOUT_MS},
+        {"checkpoint", required_argument, 0, OPTION_CHECKPOINT},
+        {"resume", required_argument, 0, OPTION_RESUME},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((c = getopt_long(argc, argv, "aACg::o:uvn::c:j:s:rd:bL:p:P:h", long_options, &option_index)) != -1) {
+        switch (c) {
+        case 'a':
+            option.all = true;
+            option.mode = MODE_ALL;
+            break;
+        case 'A':
+            option.all = true;
+            option.mode = MODE_COUNT;
+            break;
+        case 'C':
+            option.all = true;
+            option.mode = MODE_COUNT_DP;
+            break;
+        case 'g':
+            option.generate_mode = true;
+            if (optarg != NULL) { //if no parameter with g the size is by default 8 
+                if (!parse_grid_dimensions(optarg, &option.grid_rows, &option.grid_cols)) {
+                    fprintf(stderr, "Error: Invalid grid size specified for generation mode.\n");
+                    print_usage();
+                    exit(EXIT_FAILURE);
+                }
+            }
+            break;
+        case 'o':
+            if (optarg != NULL) { //if no parameter the output is stdout
+                option.output_file = optarg;
+            }
+            break;
+        case 'u':
+            option.unique = true;
+            if (option.unique) {
+                fprintf(stderr, "Mode generate grid with unique solution activate.\n");
+            }
+            break;
+        case 'v':
+            option.verbose = true;
+            log_verbose = true;
+            if (option.verbose) {
+                fprintf(stderr, "Mode verbose output activate.\n");
+            }
+            break;
+        case 'n':
+            if (optarg != NULL) { //if no parameter with N the % is by default 50%
+                int number = atoi(optarg);
+                if (number < 0 || number > 100) {
+                    fprintf(stderr, "Error: Invalid N%% for the generation.\n");
+                    print_usage();
+                    exit(EXIT_FAILURE);
+                }
+                option.number = number;
+            }
+            break;
+        case 'c': {
+            int count = atoi(optarg);
+            if (count < 1) {
+                fprintf(stderr, "Error: Invalid number of grids to generate.\n");
+                print_usage();
+                exit(EXIT_FAILURE);
+            }
+            option.count = count;
+            break;
+        }
+        case 'j': {
+            int jobs = atoi(optarg);
+            if (jobs < 1 || jobs > MAX_JOBS) {
+                fprintf(stderr, "Error: Invalid number of threads (1 to %d).\n", MAX_JOBS);
+                print_usage();
+                exit(EXIT_FAILURE);
+            }
+            option.jobs = jobs;
+            break;
+        }
+        case 's': {
+            char* end = NULL;
+            option.seed = strtoull(optarg, &end, 0);
+            if (end == optarg || *end != '\0') {
+                fprintf(stderr, "Error: Invalid seed '%s'.\n", optarg);
+                print_usage();
+                exit(EXIT_FAILURE);
+            }
+            option.seed_given = true;
+            break;
+        }
+        case 'r':
+            option.rate = true;
+            break;
+        case 'd':
+            if (!parse_difficulty(optarg, &option.difficulty)) {
+                fprintf(stderr, "Error: Invalid difficulty '%s' (easy, medium or hard).\n", optarg);
+                print_usage();
+                exit(EXIT_FAILURE);
+            }
+            option.difficulty_given = true;
+            break;
+        case 'b':
+            option.batch = true;
+            break;
+        case 'L':
+            if (!parse_propagation(optarg, &option.propagation)) {
+                fprintf(stderr, "Error: Invalid propagation '%s' (basic, lines or probe).\n", optarg);
+                print_usage();
+                exit(EXIT_FAILURE);
+            }
+            option.propagation_given = true;
+            break;
+        case 'p': {
+            int depth = atoi(optarg);
+            if (depth < 0 || depth > PROBE_MAX_DEPTH) {
+                fprintf(stderr, "Error: Invalid probing depth (0 to %d).\n", PROBE_MAX_DEPTH);
+                print_usage();
+                exit(EXIT_FAILURE);
+            }
+            option.probe_depth = depth;
+            break;
+        }
+        case 'P': {
+            char* end = NULL;
+            long budget = strtol(optarg, &end, 10);
+            if (end == optarg || *end != '\0' || budget < 0) {
+                fprintf(stderr, "Error: Invalid probing budget '%s'.\n", optarg);
+                print_usage();
+                exit(EXIT_FAILURE);
+            }
+            option.probe_budget = budget;
+            break;
+        }
+        case OPTION_MAX_NODES: {
+            char* end = NULL;
+            option.max_nodes = strtoull(optarg, &end, 10);
+            if (end == optarg || *end != '\0' || optarg[0] == '-') {
+                fprintf(stderr, "Error: Invalid node budget '%s'.\n", optarg);
+                print_usage();
+                exit(EXIT_FAILURE);
+            }
+            break;
+        }
+        case OPTION_TIMEOUT_MS: {
+            char* end = NULL;
+            long timeout = strtol(optarg, &end, 10);
+            if (end == optarg || *end != '\0' || timeout < 0) {
+                fprintf(stderr, "Error: Invalid time limit '%s'.\n", optarg);
+                print_usage();
+                exit(EXIT_FAILURE);
+            }
+            option.timeout_ms = timeout;
+            break;
+        }
+        case OPTION_CHECKPOINT:
+            option.checkpoint_file = optarg;
+            break;
+        case OPTION_RESUME:
+            option.resume_file = optarg;
+            break;
+        case 'h':
+            print_usage();
+            exit(EXIT_SUCCESS);
+        case '?':
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (argc == 1) {
+        fprintf(stderr, "Error: no input grid given!\n\n");
+        print_usage();
+        exit(EXIT_FAILURE);
+    }
+
+    if (option.unique && !option.generate_mode) {
+        fprintf(stderr, "warning: option 'unique' conflict with solver mode, exiting!\n\n");
+        print_usage();
+        exit(EXIT_FAILURE);
+    }
+
+    if (option.all && option.generate_mode) {
+        fprintf(stderr, "warning: option 'all' conflict with generate mode, exiting!\n\n");
+        print_usage();
+        exit(EXIT_FAILURE);
+    }
+
+    if (option.rate && option.generate_mode) {
+        fprintf(stderr, "warning: option 'rate' conflict with generate mode, exiting!\n\n");
+        print_usage();
+        exit(EXIT_FAILURE);
+    }
+
+    if (option.batch && option.generate_mode) {
+        fprintf(stderr, "warning: option 'batch' conflict with generate mode, exiting!\n\n");
+        print_usage();
+        exit(EXIT_FAILURE);
+    }
+
+    if (option.difficulty_given && !option.generate_mode) {
+        fprintf(stderr, "warning: option 'difficulty' conflict with solver mode, exiting!\n\n");
+        print_usage();
+        exit(EXIT_FAILURE);
+    }
+
+    // A resumed search keeps saving itself to its checkpoint, which only -a and -A write
+    if (option.resume_file != NULL && option.checkpoint_file == NULL) {
+        option.checkpoint_file = option.resume_file;
+    }
+    if (option.checkpoint_file != NULL &&
+        ((option.mode != MODE_ALL && option.mode != MODE_COUNT) || option.batch || option.rate || option.generate_mode)) {
+        fprintf(stderr, "warning: options 'checkpoint' and 'resume' need -a or -A on a single grid, exiting!\n\n");
+        print_usage();
+        exit(EXIT_FAILURE);
+    }
+
+    // A probing depth alone selects the probe tier, and the probe tier alone probes one level deep
+    if (option.probe_depth > 0 && !option.propagation_given) {
+        option.propagation = TIER_PROBE;
+    }
+    if (option.propagation == TIER_PROBE && option.probe_depth == 0) {
+        option.probe_depth = 1;
+    }
+    if (option.propagation != TIER_PROBE) {
+        option.probe_depth = 0;
+    }
+
+    // SIGINT and SIGTERM stop the current search or generation cleanly, with its partial results
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_interrupt;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    option.cancel = &interrupted;
+
+    //We are un generate_mode
+    if (option.generate_mode) {
+        // Check if the grid size is specified
+        if (option.grid_rows <= 0 || option.grid_cols <= 0) {
+            fprintf(stderr, "Error: In generator mode, you need to specify a correct grid size.\n");
+            print_usage();
+            exit(EXIT_FAILURE);
+        }
+        if (!option.seed_given) {
+            option.seed = rng_default_seed();
+        }
+        if (option.verbose) {
+            fprintf(stderr, "Generating %d grid(s) %d*%d with a generation of %d%% on %d thread(s), seed %llu\n",
+                option.count, option.grid_rows, option.grid_cols, option.number, option.jobs,
+                (unsigned long long)option.seed);
+        }
+
+        FILE* file = stdout;
+        if (option.output_file != NULL) {
+            file = fopen(option.output_file, "w");
+            if (file == NULL) {
+                perror("Error when opening the file");
+                exit(EXIT_FAILURE);
+            }
+        }
+        // Generate the grids with the specified percentage (-n), streamed in order
+        int status = generate_batch(&option, file);
+        if (file != stdout) {
+            fclose(file);
+        }
+        if (atomic_load(&interrupted)) {
+            fprintf(stderr, "Interrupted, the grids generated so far were written.\n");
+            exit(128 + interrupt_signal);
+        }
+        if (status != EXIT_SUCCESS) {
+            fprintf(stderr, "Error: Grid generation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // We are in solver mode, check if a grid file was provided as an argument
+    if (optind < argc) {
+        const char* filename = argv[optind];
+        t_grid_reader reader;
+        if (!grid_reader_open(&reader, filename, option.batch)) {
+            fprintf(stderr, "\nFailed to parse grid from file '%s'\n", filename);
+            exit(EXIT_FAILURE);
+        }
+
+        FILE* file = NULL;
+        int status = EXIT_SUCCESS;
+        int count = 0;
+        int read;
+        t_grid myGridPars;
+
+        // Grids are handled one at a time as they are read, and their outputs separated by a blank line
+        while ((read = grid_read(&reader, &myGridPars)) == EXIT_SUCCESS) {
+            if (file == NULL) {
+                file = stdout;
+                if (option.output_file != NULL) {
+                    file = fopen(option.output_file, "w");
+                    if (file == NULL) {
+                        perror("Error when opening the file");
+                        exit(EXIT_FAILURE);
+                    }
+                }
+            }
+            if (count > 0) {
+                fprintf(file, "\n");
+            }
+            if (process_grid(&myGridPars, file) != EXIT_SUCCESS) {
+                status = EXIT_FAILURE;
+            }
+            grid_free(&myGridPars);
+            count++;
+            if (atomic_load(&interrupted)) {
+                fprintf(stderr, "Interrupted after %d grid(s).\n", count);
+                status = 128 + interrupt_signal;
+                break;
+            }
+        }
+        if (file != NULL && file != stdout) {
+            fclose(file);
+        }
+
+        if (read == EXIT_FAILURE || count == 0) {
+            if (read == EOF) {
+                fprintf(stderr, "takuzu: error: no grid in the file\n");
+            }
+            else if (read == EXIT_FAILURE) {
+                fprintf(stderr, "takuzu: error: %s\n", reader.error);
+            }
+            fprintf(stderr, "\nFailed to parse grid from file '%s'\n", filename);
+            grid_reader_close(&reader);
+            exit(EXIT_FAILURE);
+        }
+        grid_reader_close(&reader);
+        exit(status);
+    }
+
+    return 0;
+}
\ No newline at end of file
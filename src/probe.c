@@ -0,0 +1,173 @@
+#include "../include/probe.h"
+
+
+/*
+ * Failed-literal probing tries a value in an empty cell and propagates it: if the
+ * grid becomes inconsistent, the cell takes the other value. When both values
+ * propagate, the cells that both fill with the same value are deduced as well.
+ * Values are tried in place and undone with the trail, so no grid is copied, and
+ * a probe may itself probe the cells left empty by its propagation.
+ */
+
+
+// State of a call to probe_grid, shared by the nested probes
+typedef struct {
+    t_probe_propagation propagate;
+    long remaining;     // Values that may still be tried (negative: no limit)
+    int* cells;         // Per depth, the cells filled by the first value of a probe
+    char* values;       // Per depth, their values
+} t_probe_run;
+
+
+static rule_result_t probe_sweep(t_grid* g, t_probe_run* run, int depth);
+
+
+/*
+ * Propagates a tentative value, then probes the grid with one depth less until the
+ * nested probes deduce nothing.
+ *
+ * Parameters:
+ * - g: Pointer to the grid, holding the tentative value.
+ * - run: State of the probing.
+ * - depth: Depth of the probe that set the value.
+ * - mark: Trail length before the value was set.
+ *
+ * Returns:
+ * RULE_CONFLICT if the value leads to a contradiction, RULE_STABLE or RULE_SOLVED otherwise.
+ */
+static rule_result_t probe_propagate(t_grid* g, t_probe_run* run, int depth, int mark) {
+    rule_result_t result = run->propagate(g, mark);
+    while (result != RULE_CONFLICT && result != RULE_SOLVED && depth > 1) {
+        rule_result_t nested = probe_sweep(g, run, depth - 1);
+        if (nested == RULE_CONFLICT) {
+            return RULE_CONFLICT;
+        }
+        if (nested != RULE_CHANGED) {
+            break;
+        }
+        result = run->propagate(g, mark);
+    }
+    return result;
+}
+
+
+/*
+ * Probes the empty cells of a propagated grid in row-major order, and stops at the
+ * first deduction so that the caller propagates it before the next probe.
+ *
+ * Parameters:
+ * - g: Pointer to the grid, with a trail.
+ * - run: State of the probing.
+ * - depth: Depth of the probes, 1 or more.
+ *
+ * Returns:
+ * RULE_CONFLICT if both values of a cell fail, RULE_CHANGED if cells were deduced,
+ * RULE_STABLE if nothing was deduced or the budget ran out.
+ */
+static rule_result_t probe_sweep(t_grid* g, t_probe_run* run, int depth) {
+    int cells = g->rows * g->cols;
+    int* implied = run->cells + (size_t)(depth - 1) * cells;
+    char* implied_values = run->values + (size_t)(depth - 1) * cells;
+
+    for (int cell = 0; cell < cells; cell++) {
+        if (g->grid[cell] != '_') {
+            continue;
+        }
+
+        bool fails[2];
+        int kept = 0;
+        for (int value = 0; value <= 1; value++) {
+            if (run->remaining == 0) {
+                return RULE_STABLE;
+            }
+            run->remaining -= (run->remaining > 0);
+
+            int mark = g->trail_length;
+            char v = (char)('0' + value);
+            grid_fill_cell(g, cell / g->cols, cell % g->cols, v);
+            fails[value] = probe_propagate(g, run, depth, mark) == RULE_CONFLICT;
+
+            // Cells filled by the propagation of '0', then those that '1' fills the same way
+            if (!fails[value] && value == 0) {
+                for (int t = mark + 1; t < g->trail_length; t++) {
+                    implied[kept] = g->trail[t];
+                    implied_values[kept++] = g->grid[g->trail[t]];
+                }
+            }
+            else if (!fails[value] && !fails[0]) {
+                int both = 0;
+                for (int k = 0; k < kept; k++) {
+                    if (g->grid[implied[k]] == implied_values[k]) {
+                        implied[both] = implied[k];
+                        implied_values[both++] = implied_values[k];
+                    }
+                }
+                kept = both;
+            }
+            grid_undo(g, mark);
+        }
+
+        if (fails[0] && fails[1]) {
+            return RULE_CONFLICT;
+        }
+        if (fails[0] || fails[1]) {
+            grid_fill_cell(g, cell / g->cols, cell % g->cols, fails[0] ? '1' : '0');
+            return RULE_CHANGED;
+        }
+        if (kept > 0) {
+            for (int k = 0; k < kept; k++) {
+                grid_fill_cell(g, implied[k] / g->cols, implied[k] % g->cols, implied_values[k]);
+            }
+            return RULE_CHANGED;
+        }
+    }
+    return RULE_STABLE;
+}
+
+
+/*
+ * Probes the empty cells of a propagated grid until the first deduction. A grid
+ * without a trail gets one for the duration of the call.
+ *
+ * Parameters:
+ * - g: Pointer to the grid, propagated by 'propagate'.
+ * - propagate: Propagation run after each tentative value.
+ * - limits: Depth and budget of the probing.
+ *
+ * Returns:
+ * RULE_CONFLICT if both values of a cell fail, RULE_CHANGED if cells were deduced,
+ * RULE_STABLE if nothing was deduced within the limits.
+ */
+rule_result_t probe_grid(t_grid* g, t_probe_propagation propagate, const t_probe_limits* limits) {
+    if (g == NULL) {
+        fprintf(stderr, "Error: Grid is NULL in probe_grid.\n");
+        return RULE_CONFLICT;
+    }
+    if (limits->depth < 1) {
+        return RULE_STABLE;
+    }
+
+    size_t scratch = (size_t)limits->depth * g->rows * g->cols;
+    t_probe_run run;
+    run.propagate = propagate;
+    run.remaining = (limits->budget > 0) ? limits->budget : -1;
+    run.cells = (int*)malloc(scratch * sizeof(int));
+    run.values = (char*)malloc(scratch);
+    if (run.cells == NULL || run.values == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in probe_grid.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bool owned_trail = (g->trail == NULL);
+    if (owned_trail) {
+        grid_trail_start(g);
+    }
+    rule_result_t result = probe_sweep(g, &run, limits->depth);
+    if (owned_trail) {
+        grid_trail_stop(g);
+    }
+
+    free(run.cells);
+    free(run.values);
+    return result;
+}
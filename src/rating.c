@@ -0,0 +1,676 @@
+#include "../include/rating.h"
+#include "../include/probe.h"
+
+// Number of tail states of a line prefix: start, then (last value, run length 1 or 2)
+#define TAIL_STATES 5
+
+// Longest line whose counts of zeros fit the bits of a word in line_domains
+#define DOMAINS_WORD_LENGTH 64
+
+// Number of full generations tried to reach the exact target difficulty
+#define MAX_DIFFICULTY_ATTEMPTS 16
+
+
+/*
+ * Computes the tail state reached after appending a value to a line prefix.
+ *
+ * Parameters:
+ * - tail: Current tail state (0 for an empty prefix, 1 + 2 * value + (run - 1) otherwise).
+ * - value: Appended value (0 or 1).
+ *
+ * Returns:
+ * The new tail state, or -1 if the value makes three identical consecutive cells.
+ */
+static int tail_next(int tail, int value) {
+    if (tail == 0) {
+        return 1 + 2 * value;
+    }
+    int last = (tail - 1) / 2;
+    int run = (tail - 1) % 2 + 1;
+    if (last != value) {
+        return 1 + 2 * value;
+    }
+    return (run == 2) ? -1 : 2 + 2 * value;
+}
+
+
+/*
+ * Checks if a cell of a line can hold the given value.
+ */
+static bool cell_allows(char cell, int value) {
+    return cell == '_' || cell == (char)('0' + value);
+}
+
+
+/*
+ * line_domains for lines of at most DOMAINS_WORD_LENGTH cells: the states of a
+ * position and a tail are a word, whose bit z is set for z zeros so far. Appending
+ * a '0' shifts the word, appending a '1' keeps it, and the tail transitions are
+ * written out, so a position costs a dozen word operations and no table is allocated.
+ */
+static bool line_domains_word(const char* line, int length, unsigned char* domains) {
+    int half = length / 2;
+    uint64_t forward[DOMAINS_WORD_LENGTH + 1][TAIL_STATES];
+    uint64_t backward[DOMAINS_WORD_LENGTH + 1][TAIL_STATES];
+
+    // Forward pass: counts of zeros reachable from the start, at most half of each value
+    memset(forward[0], 0, sizeof(forward[0]));
+    forward[0][0] = 1;
+    for (int i = 0; i < length; i++) {
+        const uint64_t* f = forward[i];
+        uint64_t* next = forward[i + 1];
+        int min_zeros = i + 1 - half;
+        uint64_t allowed = ((2ULL << half) - 1) & ~((min_zeros > 0) ? (1ULL << min_zeros) - 1 : 0);
+        uint64_t zero = cell_allows(line[i], 0) ? allowed : 0;
+        uint64_t one = cell_allows(line[i], 1) ? allowed : 0;
+        next[0] = 0;
+        next[1] = ((f[0] | f[3] | f[4]) << 1) & zero;
+        next[2] = (f[1] << 1) & zero;
+        next[3] = (f[0] | f[1] | f[2]) & one;
+        next[4] = f[3] & one;
+    }
+
+    // Backward pass: counts of zeros from which the end of the line is reachable
+    for (int tail = 0; tail < TAIL_STATES; tail++) {
+        backward[length][tail] = 1ULL << half;
+    }
+    for (int i = length - 1; i >= 0; i--) {
+        const uint64_t* b = backward[i + 1];
+        uint64_t zero = cell_allows(line[i], 0) ? ~0ULL : 0;
+        uint64_t one = cell_allows(line[i], 1) ? ~0ULL : 0;
+        backward[i][0] = ((b[1] >> 1) & zero) | (b[3] & one);
+        backward[i][1] = ((b[2] >> 1) & zero) | (b[3] & one);
+        backward[i][2] = b[3] & one;
+        backward[i][3] = ((b[1] >> 1) & zero) | (b[4] & one);
+        backward[i][4] = (b[1] >> 1) & zero;
+    }
+
+    // A value is possible if a reachable state leads to a state that reaches the end
+    bool feasible = (backward[0][0] & 1) != 0;
+    for (int i = 0; i < length; i++) {
+        const uint64_t* f = forward[i];
+        const uint64_t* b = backward[i + 1];
+        uint64_t zero = (((f[0] | f[3] | f[4]) << 1) & b[1]) | ((f[1] << 1) & b[2]);
+        uint64_t one = ((f[0] | f[1] | f[2]) & b[3]) | (f[3] & b[4]);
+        domains[i] = 0;
+        if (feasible && cell_allows(line[i], 0) && zero != 0) {
+            domains[i] |= 1;
+        }
+        if (feasible && cell_allows(line[i], 1) && one != 0) {
+            domains[i] |= 2;
+        }
+    }
+    return feasible;
+}
+
+
+/*
+ * Computes, for every cell of a line, the values that appear in at least one completion
+ * of the line respecting the balance rule and the no-three-in-a-row rule.
+ * This is an exact per-line deduction, done by dynamic programming over the states
+ * (position, number of zeros, tail) in O(length^2), with a word of states per
+ * position and tail on lines of up to DOMAINS_WORD_LENGTH cells.
+ *
+ * Parameters:
+ * - line: Cells of the line ('0', '1' or '_').
+ * - length: Number of cells in the line (even).
+ * - domains: Output, bit 0 set if '0' is possible, bit 1 set if '1' is possible.
+ *
+ * Returns:
+ * True if the line has at least one completion; otherwise, false.
+ */
+bool line_domains(const char* line, int length, unsigned char* domains) {
+    if (length <= DOMAINS_WORD_LENGTH) {
+        return line_domains_word(line, length, domains);
+    }
+    int half = length / 2;
+    int states = (half + 1) * TAIL_STATES;
+    unsigned char* forward = calloc((size_t)(length + 1) * states, 1);
+    unsigned char* backward = calloc((size_t)(length + 1) * states, 1);
+    if (forward == NULL || backward == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in line_domains.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Forward pass: states reachable from the start of the line
+    forward[0] = 1;
+    for (int i = 0; i < length; i++) {
+        for (int zeros = 0; zeros <= half; zeros++) {
+            for (int tail = 0; tail < TAIL_STATES; tail++) {
+                if (!forward[i * states + zeros * TAIL_STATES + tail]) {
+                    continue;
+                }
+                for (int value = 0; value <= 1; value++) {
+                    int next_zeros = zeros + (value == 0);
+                    int next_tail = tail_next(tail, value);
+                    if (!cell_allows(line[i], value) || next_tail < 0 ||
+                        next_zeros > half || i + 1 - next_zeros > half) {
+                        continue;
+                    }
+                    forward[(i + 1) * states + next_zeros * TAIL_STATES + next_tail] = 1;
+                }
+            }
+        }
+    }
+
+    // Backward pass: states from which the end of the line is reachable
+    for (int tail = 0; tail < TAIL_STATES; tail++) {
+        backward[length * states + half * TAIL_STATES + tail] = 1;
+    }
+    for (int i = length - 1; i >= 0; i--) {
+        for (int zeros = 0; zeros <= half; zeros++) {
+            for (int tail = 0; tail < TAIL_STATES; tail++) {
+                for (int value = 0; value <= 1; value++) {
+                    int next_zeros = zeros + (value == 0);
+                    int next_tail = tail_next(tail, value);
+                    if (!cell_allows(line[i], value) || next_tail < 0 || next_zeros > half) {
+                        continue;
+                    }
+                    if (backward[(i + 1) * states + next_zeros * TAIL_STATES + next_tail]) {
+                        backward[i * states + zeros * TAIL_STATES + tail] = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    // A value is possible if a reachable state leads to a state that reaches the end
+    bool feasible = backward[0] != 0;
+    for (int i = 0; i < length; i++) {
+        domains[i] = 0;
+        for (int zeros = 0; zeros <= half && feasible; zeros++) {
+            for (int tail = 0; tail < TAIL_STATES; tail++) {
+                if (!forward[i * states + zeros * TAIL_STATES + tail]) {
+                    continue;
+                }
+                for (int value = 0; value <= 1; value++) {
+                    int next_zeros = zeros + (value == 0);
+                    int next_tail = tail_next(tail, value);
+                    if (!cell_allows(line[i], value) || next_tail < 0 || next_zeros > half) {
+                        continue;
+                    }
+                    if (backward[(i + 1) * states + next_zeros * TAIL_STATES + next_tail]) {
+                        domains[i] |= (unsigned char)(1 << value);
+                    }
+                }
+            }
+        }
+    }
+
+    free(forward);
+    free(backward);
+    return feasible;
+}
+
+
+/*
+ * Fills the cells of a line whose value is the same in all its completions.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid.
+ * - is_row: The line is a row (true) or a column (false).
+ * - index: Index of the line.
+ * - line, domains: Scratch buffers of the length of the longest line.
+ *
+ * Returns:
+ * RULE_CONFLICT if the line has no completion, RULE_CHANGED if cells were filled,
+ * RULE_STABLE otherwise.
+ */
+static rule_result_t complete_line(t_grid* g, bool is_row, int index, char* line, unsigned char* domains) {
+    // Rows have g->cols cells, columns have g->rows cells
+    int length = is_row ? g->cols : g->rows;
+    if ((is_row ? g->row_empty : g->col_empty)[index] == 0) {
+        return RULE_STABLE;
+    }
+    memcpy(line, grid_line(g, is_row, index), length);
+    if (!line_domains(line, length, domains)) {
+        return RULE_CONFLICT;
+    }
+
+    rule_result_t result = RULE_STABLE;
+    for (int i = 0; i < length; i++) {
+        if (line[i] == '_' && (domains[i] == 1 || domains[i] == 2)) {
+            char value = (domains[i] == 1) ? '0' : '1';
+            if (is_row) {
+                grid_fill_cell(g, index, i, value);
+            }
+            else {
+                grid_fill_cell(g, i, index, value);
+            }
+            result = RULE_CHANGED;
+        }
+    }
+    return result;
+}
+
+
+/*
+ * Line completion rule: fills every cell whose value is the same in all the
+ * completions of its row or of its column.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid.
+ *
+ * Returns:
+ * RULE_CONFLICT if a line has no completion, RULE_CHANGED if cells were filled,
+ * RULE_STABLE otherwise.
+ */
+rule_result_t apply_line_completion(t_grid* g) {
+    if (g == NULL) {
+        fprintf(stderr, "Error: Grid is NULL in apply_line_completion.\n");
+        return RULE_CONFLICT;
+    }
+
+    int longest = (g->rows > g->cols) ? g->rows : g->cols;
+    char* line = malloc(longest);
+    unsigned char* domains = malloc(longest);
+    if (line == NULL || domains == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in apply_line_completion.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    rule_result_t result = RULE_STABLE;
+    for (int index = 0; index < g->rows + g->cols && result != RULE_CONFLICT; index++) {
+        bool is_row = index < g->rows;
+        rule_result_t line_result = complete_line(g, is_row, is_row ? index : index - g->rows, line, domains);
+        if (line_result != RULE_STABLE) {
+            result = line_result;
+        }
+    }
+
+    free(line);
+    free(domains);
+    return result;
+}
+
+
+/*
+ * Line completion rule on the lines of the cells filled since a mark of the trail.
+ * The rule only reads the cells of a line, so on a grid where it was stable at the
+ * mark, the other lines have nothing to complete.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid, with a trail.
+ * - mark: Trail length when the rule was last stable.
+ *
+ * Returns:
+ * RULE_CONFLICT if a line has no completion, RULE_CHANGED if cells were filled,
+ * RULE_STABLE otherwise.
+ */
+rule_result_t apply_line_completion_since(t_grid* g, int mark) {
+    if (g == NULL) {
+        fprintf(stderr, "Error: Grid is NULL in apply_line_completion_since.\n");
+        return RULE_CONFLICT;
+    }
+
+    int longest = (g->rows > g->cols) ? g->rows : g->cols;
+    char* line = malloc(longest);
+    unsigned char* domains = malloc(longest);
+    uint64_t* seen = calloc((size_t)(g->rows + g->cols + 63) / 64, sizeof(uint64_t));
+    if (line == NULL || domains == NULL || seen == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in apply_line_completion_since.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Lines filled by the rule itself are left to the next call
+    int end = g->trail_length;
+    rule_result_t result = RULE_STABLE;
+    for (int t = mark; t < end && result != RULE_CONFLICT; t++) {
+        int i = g->trail[t] / g->cols;
+        int j = g->trail[t] - i * g->cols;
+        int lines[2] = { i, g->rows + j };
+        for (int k = 0; k < 2 && result != RULE_CONFLICT; k++) {
+            uint64_t bit = 1ULL << (lines[k] % 64);
+            if (seen[lines[k] / 64] & bit) {
+                continue;
+            }
+            seen[lines[k] / 64] |= bit;
+            rule_result_t line_result = complete_line(g, k == 0, (k == 0) ? i : j, line, domains);
+            if (line_result != RULE_STABLE) {
+                result = line_result;
+            }
+        }
+    }
+
+    free(line);
+    free(domains);
+    free(seen);
+    return result;
+}
+
+
+/*
+ * Propagation of the probes of the rating: the basic rules and the lines tier.
+ */
+static rule_result_t rating_probe_propagate(t_grid* g, int mark) {
+    (void)mark;
+    return propagate_tiers(g, TIER_LINES, NULL);
+}
+
+
+/*
+ * Probing rule: tries both values of each empty cell, propagates with the basic rules
+ * and the lines tier, and fixes the cell to the other value if one of them leads to
+ * a contradiction, or the cells that both values fill alike. Stops at the first
+ * deduction, so the cheaper tiers run again before the next probe.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid.
+ *
+ * Returns:
+ * RULE_CONFLICT if both values of a cell fail, RULE_CHANGED if cells were fixed,
+ * RULE_STABLE otherwise.
+ */
+rule_result_t apply_probing(t_grid* g) {
+    const t_probe_limits limits = { 1, 0 };
+    return probe_grid(g, rating_probe_propagate, &limits);
+}
+
+
+/*
+ * Propagates the grid with tiers of increasing cost: the basic rules run to a fixpoint,
+ * and a more expensive tier is only used when all the cheaper ones are stuck.
+ * As soon as progress requires a tier above max_tier, the function gives up, which lets
+ * the generator reject a candidate cheaply.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid, modified in place.
+ * - max_tier: Most expensive tier allowed.
+ * - rating: Statistics updated by the propagation, or NULL.
+ *
+ * Returns:
+ * RULE_SOLVED if the grid is complete, RULE_CONFLICT if a contradiction was found,
+ * RULE_STABLE if propagation is stuck within max_tier.
+ */
+rule_result_t propagate_tiers(t_grid* g, tier_t max_tier, t_rating* rating) {
+    t_rating unused;
+    if (rating == NULL) {
+        rating = &unused;
+        memset(rating, 0, sizeof(*rating));
+    }
+
+    while (1) {
+        if (!is_consistent(g)) {
+            rating->conflict = true;
+            return RULE_CONFLICT;
+        }
+
+        if (apply_heuristics_once(g)) {
+            rating->basic_rounds++;
+            rating->rounds++;
+            continue;
+        }
+
+        if (g->empty == 0) {
+            rating->solved = true;
+            return RULE_SOLVED;
+        }
+
+        if (max_tier < TIER_LINES) {
+            break;
+        }
+        rule_result_t result = apply_line_completion(g);
+        if (result == RULE_CONFLICT) {
+            rating->conflict = true;
+            return RULE_CONFLICT;
+        }
+        if (result == RULE_CHANGED || apply_distinct_lines(g)) {
+            if (rating->tier < TIER_LINES) {
+                rating->tier = TIER_LINES;
+            }
+            rating->line_rounds++;
+            rating->rounds++;
+            continue;
+        }
+
+        if (max_tier < TIER_PROBE) {
+            break;
+        }
+        result = apply_probing(g);
+        if (result == RULE_CONFLICT) {
+            rating->conflict = true;
+            return RULE_CONFLICT;
+        }
+        if (result == RULE_CHANGED) {
+            rating->tier = TIER_PROBE;
+            rating->probe_rounds++;
+            rating->rounds++;
+            continue;
+        }
+        break;
+    }
+
+    // Stuck: at least the next tier (or branching) would be needed
+    rating->tier = (tier_t)(max_tier + 1);
+    return RULE_STABLE;
+}
+
+
+/*
+ * Rates the difficulty of a grid: the hardest tier needed to solve it without branching,
+ * and the number of propagation rounds of each tier.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid (not modified).
+ * - max_tier: Most expensive tier allowed; the rating stops as soon as it is exceeded.
+ * - rating: Output rating.
+ */
+void rate_grid(const t_grid* g, tier_t max_tier, t_rating* rating) {
+    memset(rating, 0, sizeof(*rating));
+    rating->tier = TIER_BASIC;
+
+    t_grid copy;
+    grid_allocate(&copy, g->rows, g->cols);
+    grid_copy(g, &copy);
+    propagate_tiers(&copy, max_tier, rating);
+    grid_free(&copy);
+}
+
+
+/*
+ * Returns the name of the difficulty associated with a tier.
+ */
+const char* difficulty_name(tier_t tier) {
+    switch (tier) {
+    case TIER_BASIC:
+        return "easy";
+    case TIER_LINES:
+        return "medium";
+    case TIER_PROBE:
+        return "hard";
+    default:
+        return "expert";
+    }
+}
+
+
+/*
+ * Parses a difficulty name given to --difficulty.
+ *
+ * Parameters:
+ * - name: "easy", "medium" or "hard".
+ * - tier: Output tier.
+ *
+ * Returns:
+ * True if the name is valid; otherwise, false.
+ */
+bool parse_difficulty(const char* name, tier_t* tier) {
+    for (tier_t t = TIER_BASIC; t < TIER_BRANCH; t++) {
+        if (strcmp(name, difficulty_name(t)) == 0) {
+            *tier = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/*
+ * Prints a rating to the given file stream.
+ *
+ * Parameters:
+ * - rating: Rating to print.
+ * - fd: File stream (e.g., stdout, a file).
+ */
+void rating_print(const t_rating* rating, FILE* fd) {
+    static const char* tier_names[] = { "basic", "lines", "probe", "branch" };
+
+    if (rating->conflict) {
+        fprintf(fd, "The grid has no solution.\n");
+        return;
+    }
+    fprintf(fd, "Difficulty: %s (tier: %s)\n", difficulty_name(rating->tier), tier_names[rating->tier]);
+    fprintf(fd, "Propagation rounds: %d (basic: %d, lines: %d, probe: %d)\n",
+        rating->rounds, rating->basic_rounds, rating->line_rounds, rating->probe_rounds);
+    fprintf(fd, "Branching required: %s\n", rating->solved ? "no" : "yes");
+}
+
+
+/*
+ * Tells whether the flag of a generation is set (NULL: never).
+ */
+static inline bool generation_cancelled(const atomic_bool* cancel) {
+    return cancel != NULL && atomic_load_explicit(cancel, memory_order_relaxed);
+}
+
+
+/*
+ * Recursive helper of generate_random_solution: propagates, then branches on the
+ * first empty cell with a random value first.
+ */
+static bool fill_random_solution(t_grid* g, const atomic_bool* cancel, t_rng* rng) {
+    if (generation_cancelled(cancel)) {
+        return false;
+    }
+    rule_result_t result = propagate_tiers(g, TIER_LINES, NULL);
+    if (result != RULE_STABLE) {
+        return result == RULE_SOLVED;
+    }
+
+    choice_t choice = grid_choice_ordered(g, '0');
+    t_grid saved;
+    grid_allocate(&saved, g->rows, g->cols);
+    grid_copy(g, &saved);
+
+    int first = rng_bit(rng);
+    for (int k = 0; k <= 1; k++) {
+        grid_fill_cell(g, choice.row, choice.column, (char)('0' + (first ^ k)));
+        if (fill_random_solution(g, cancel, rng)) {
+            grid_free(&saved);
+            return true;
+        }
+        grid_copy(&saved, g);
+    }
+
+    grid_free(&saved);
+    return false;
+}
+
+
+/*
+ * Fills an empty grid with a random complete and valid solution.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid (allocated, every cell '_').
+ * - cancel: Flag that stops the search once set, read at each node (NULL: none).
+ * - rng: Random generator owned by the caller.
+ *
+ * Returns:
+ * True if a solution was found; otherwise (or if cancelled), false.
+ */
+bool generate_random_solution(t_grid* g, const atomic_bool* cancel, t_rng* rng) {
+    if (g == NULL) {
+        fprintf(stderr, "Error: Grid is NULL in generate_random_solution.\n");
+        return false;
+    }
+    return fill_random_solution(g, cancel, rng);
+}
+
+
+/*
+ * Generates a puzzle of the target difficulty by removing clues from a random solution.
+ * Clues are visited in random order and a removal is kept only if the puzzle stays
+ * solvable without branching within the target tier; the rating of each candidate
+ * stops as soon as a harder tier would be needed. The result has a unique solution.
+ * Several solutions are tried to reach exactly the target tier; otherwise the hardest
+ * puzzle found is kept.
+ *
+ * Parameters:
+ * - g: Pointer to the Takuzu grid to be generated (allocated with the wanted size).
+ * - target: Target tier (TIER_BASIC, TIER_LINES or TIER_PROBE).
+ * - cancel: Flag that stops the generation once set, read before each rating (NULL: none).
+ * - rng: Random generator owned by the caller.
+ *
+ * Returns:
+ * false if the grid is NULL or the generation was cancelled (the grid is then not a
+ * puzzle), true otherwise.
+ */
+bool generate_grid_with_difficulty(t_grid* g, tier_t target, const atomic_bool* cancel, t_rng* rng) {
+    if (g == NULL) {
+        fprintf(stderr, "Error: Grid is NULL in generate_grid_with_difficulty.\n");
+        return false;
+    }
+
+    int cells = g->rows * g->cols;
+    int* order = malloc(cells * sizeof(int));
+    if (order == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in generate_grid_with_difficulty.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    t_grid best;
+    grid_allocate(&best, g->rows, g->cols);
+    int best_tier = -1;
+    t_rating rating;
+
+    for (int attempt = 0; attempt < MAX_DIFFICULTY_ATTEMPTS && best_tier != (int)target; attempt++) {
+        grid_reset(g);
+        if (!generate_random_solution(g, cancel, rng)) {
+            if (generation_cancelled(cancel)) {
+                break;
+            }
+            continue;
+        }
+
+        for (int i = 0; i < cells; i++) {
+            order[i] = i;
+        }
+        rng_shuffle(rng, order, cells);
+
+        // Dig holes while the puzzle stays within the target tier
+        for (int i = 0; i < cells; i++) {
+            if (generation_cancelled(cancel)) {
+                break;
+            }
+            int row = order[i] / g->cols;
+            int col = order[i] % g->cols;
+            char saved = grid_cell(g, row, col);
+            grid_clear_cell(row, col, g);
+            rate_grid(g, target, &rating);
+            if (!rating.solved) {
+                grid_fill_cell(g, row, col, saved);
+            }
+        }
+
+        if (generation_cancelled(cancel)) {
+            break;
+        }
+        rate_grid(g, target, &rating);
+        if ((int)rating.tier > best_tier) {
+            best_tier = rating.tier;
+            grid_copy(g, &best);
+        }
+    }
+
+    free(order);
+    if (generation_cancelled(cancel)) {
+        grid_free(&best);
+        return false;
+    }
+    if (best_tier < 0) {
+        LOG_INFO("Error: Unable to generate a grid of difficulty %s.\n", difficulty_name(target));
+    }
+    grid_copy(&best, g);
+    grid_free(&best);
+    return true;
+}
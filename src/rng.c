@@ -0,0 +1,143 @@
+#include <time.h>
+
+#include "../include/rng.h"
+
+
+/*
+ * Advances a splitmix64 state and returns the next output.
+ * Only used to expand a 64-bit seed into a full xoshiro256** state.
+ *
+ * Parameters:
+ * - state: Pointer to the splitmix64 state.
+ *
+ * Returns:
+ * The next 64-bit output of the splitmix64 sequence.
+ */
+static uint64_t splitmix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+static inline uint64_t rotl(const uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+
+/*
+ * Seeds the generator with a stream derived from a user seed.
+ * Two different (seed, stream) pairs give statistically independent sequences,
+ * so a puzzle index can be used as the stream to make batch generation reproducible
+ * whatever the number of threads.
+ *
+ * Parameters:
+ * - rng: Pointer to the generator to seed.
+ * - seed: User seed (e.g. the value of --seed).
+ * - stream: Index of the stream to derive from the seed.
+ */
+void rng_seed(t_rng* rng, uint64_t seed, uint64_t stream) {
+    uint64_t state = seed;
+    // Mix the stream index into the seed before expanding it
+    uint64_t mixed = splitmix64(&state) ^ (stream * 0xD1B54A32D192ED03ULL);
+    state = mixed;
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = splitmix64(&state);
+    }
+}
+
+
+/*
+ * Builds a seed from the clock, for runs where no --seed is given.
+ *
+ * Returns:
+ * A 64-bit seed that changes between runs, even within the same second.
+ */
+uint64_t rng_default_seed(void) {
+    uint64_t state = (uint64_t)time(NULL);
+    state ^= (uint64_t)clock() << 32;
+    return splitmix64(&state);
+}
+
+
+/*
+ * Returns the next 64-bit output of the generator (xoshiro256**).
+ *
+ * Parameters:
+ * - rng: Pointer to the generator.
+ *
+ * Returns:
+ * A uniformly distributed 64-bit value.
+ */
+uint64_t rng_next(t_rng* rng) {
+    uint64_t* s = rng->s;
+    const uint64_t result = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
+
+/*
+ * Returns a uniformly distributed integer in [0, bound) without modulo bias
+ * (Lemire's multiply-and-reject method).
+ *
+ * Parameters:
+ * - rng: Pointer to the generator.
+ * - bound: Exclusive upper bound, must be greater than 0.
+ *
+ * Returns:
+ * An integer in [0, bound).
+ */
+uint32_t rng_below(t_rng* rng, uint32_t bound) {
+    uint64_t product = (rng_next(rng) >> 32) * bound;
+    uint32_t low = (uint32_t)product;
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            product = (rng_next(rng) >> 32) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return (uint32_t)(product >> 32);
+}
+
+
+/*
+ * Returns a single random bit.
+ *
+ * Parameters:
+ * - rng: Pointer to the generator.
+ *
+ * Returns:
+ * 0 or 1 with equal probability.
+ */
+int rng_bit(t_rng* rng) {
+    return (int)(rng_next(rng) >> 63);
+}
+
+
+/*
+ * Shuffles an array of integers in place (Fisher-Yates).
+ *
+ * Parameters:
+ * - rng: Pointer to the generator.
+ * - array: Array to shuffle.
+ * - length: Number of elements in the array.
+ */
+void rng_shuffle(t_rng* rng, int* array, int length) {
+    for (int i = length - 1; i > 0; i--) {
+        int j = (int)rng_below(rng, (uint32_t)i + 1);
+        int tmp = array[i];
+        array[i] = array[j];
+        array[j] = tmp;
+    }
+}
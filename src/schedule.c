@@ -0,0 +1,212 @@
+#include "../include/schedule.h"
+
+
+/*
+ * The scheduler runs the propagation rules from the cheapest to the most expensive,
+ * and goes back to the cheapest one each time a rule fills a cell: a rule only runs
+ * once every cheaper rule is stuck. Each rule keeps a moving average of the runs
+ * that found something; while it is below SCHEDULE_MIN_YIELD, the rule only runs
+ * once every SCHEDULE_SKIP + 1 turns, which is enough to notice when it pays again.
+ * Skipping a rule only weakens the propagation: every rule is sound, and the
+ * consistency check of the solver does not depend on them.
+ */
+
+
+// Basic rules a rule belongs to
+typedef enum {
+    RULES_ANY,      // Every call
+    RULES_GENERIC,  // Calls with the generic kernels: the rules of grid.c run one by one
+    RULES_SIZED     // Calls with kernels for the size of the grid
+} rule_kind_t;
+
+// Rule of the scheduler
+typedef struct {
+    const char* name;
+    tier_t tier;
+    rule_kind_t kind;
+    bool (*heuristic)(t_grid* g);                           // Rule of grid.c (NULL: see apply)
+    rule_result_t (*apply)(t_schedule* schedule, t_grid* g);
+} t_rule;
+
+
+/*
+ * Propagation of the probes: the kernels for the size of the grid and the distinct
+ * lines rule, which was stable when the probe started.
+ */
+static rule_result_t schedule_probe_propagate(t_grid* g, int mark) {
+    const t_kernels* kernels = kernels_select(g);
+    while (kernels->propagate(g) || apply_distinct_lines_since(g, mark)) {
+        // Rounds are applied until no rule fills a cell
+    }
+    return kernels->consistent(g) ? RULE_STABLE : RULE_CONFLICT;
+}
+
+
+static rule_result_t rule_kernels(t_schedule* schedule, t_grid* g) {
+    return schedule->kernels->propagate(g) ? RULE_CHANGED : RULE_STABLE;
+}
+
+
+static rule_result_t rule_distinct_lines(t_schedule* schedule, t_grid* g) {
+    bool changed = (schedule->mark < 0) ? apply_distinct_lines(g) : apply_distinct_lines_since(g, schedule->mark);
+    return changed ? RULE_CHANGED : RULE_STABLE;
+}
+
+
+static rule_result_t rule_line_completion(t_schedule* schedule, t_grid* g) {
+    rule_result_t result = (schedule->mark < 0) ? apply_line_completion(g) : apply_line_completion_since(g, schedule->mark);
+    return (result == RULE_SOLVED) ? RULE_CHANGED : result;
+}
+
+
+static rule_result_t rule_probing(t_schedule* schedule, t_grid* g) {
+    return probe_grid(g, schedule_probe_propagate, &schedule->probe);
+}
+
+
+// Rules by tier, and by cost within a tier
+static const t_rule schedule_rules[SCHEDULE_RULES] = {
+    { "kernels",          TIER_BASIC, RULES_SIZED,   NULL, rule_kernels },
+    { "pairs-rows",       TIER_BASIC, RULES_GENERIC, apply_consecutive_zeros_ones_rows, NULL },
+    { "pairs-columns",    TIER_BASIC, RULES_GENERIC, apply_consecutive_zeros_ones_columns, NULL },
+    { "middle",           TIER_BASIC, RULES_GENERIC, middle_pattern_heuristic, NULL },
+    { "half-zeros-rows",  TIER_BASIC, RULES_GENERIC, apply_all_zeros_filled_rows, NULL },
+    { "half-zeros-cols",  TIER_BASIC, RULES_GENERIC, apply_all_zeros_filled_columns, NULL },
+    { "half-ones-rows",   TIER_BASIC, RULES_GENERIC, apply_all_ones_filled_rows, NULL },
+    { "half-ones-cols",   TIER_BASIC, RULES_GENERIC, apply_all_ones_filled_columns, NULL },
+    { "distinct-lines",   TIER_LINES, RULES_ANY,     NULL, rule_distinct_lines },
+    { "line-completion",  TIER_LINES, RULES_ANY,     NULL, rule_line_completion },
+    { "probing",          TIER_PROBE, RULES_ANY,     NULL, rule_probing }
+};
+
+// Names of the tiers accepted by --propagation
+static const char* propagation_names[] = { "basic", "lines", "probe" };
+
+
+/*
+ * Initializes a scheduler whose rules all start with a full yield.
+ *
+ * Parameters:
+ * - schedule: Pointer to the scheduler.
+ * - max_tier: Most expensive tier run (TIER_BASIC to TIER_PROBE).
+ * - probe: Limits of the probing tier.
+ */
+void schedule_init(t_schedule* schedule, tier_t max_tier, const t_probe_limits* probe) {
+    schedule->max_tier = (max_tier > TIER_PROBE) ? TIER_PROBE : max_tier;
+    schedule->probe = *probe;
+    schedule->kernels = &kernels_generic;
+    schedule->mark = -1;
+    memset(schedule->yield, 0, sizeof(schedule->yield));
+    for (int i = 0; i < SCHEDULE_RULES; i++) {
+        schedule->yield[i].yield = SCHEDULE_FULL_YIELD;
+    }
+}
+
+
+/*
+ * Records the result of a run of a rule, and how long the rule is skipped after it.
+ */
+static void schedule_record(t_rule_yield* yield, rule_result_t result) {
+    int found = (result != RULE_STABLE) ? SCHEDULE_FULL_YIELD : 0;
+    yield->runs++;
+    yield->hits += (result != RULE_STABLE);
+    yield->yield += (found - yield->yield) >> SCHEDULE_DECAY;
+    yield->skip = (yield->yield < SCHEDULE_MIN_YIELD) ? SCHEDULE_SKIP : 0;
+}
+
+
+/*
+ * Propagates a grid to a fixpoint of the rules of the scheduler, up to its most
+ * expensive tier.
+ *
+ * Parameters:
+ * - schedule: Pointer to the scheduler, whose yields are updated.
+ * - g: Pointer to the grid. Probing and the incremental distinct lines rule need a trail.
+ * - kernels: Basic rules for the grid; with the generic kernels, the rules of grid.c
+ *   run one by one instead.
+ * - mark: Trail length when the grid was last stable for every rule (-1: unknown).
+ *
+ * Returns:
+ * RULE_CONFLICT if a rule found a contradiction, RULE_STABLE otherwise.
+ */
+rule_result_t schedule_propagate(t_schedule* schedule, t_grid* g, const t_kernels* kernels, int mark) {
+    if (g == NULL) {
+        fprintf(stderr, "Error: Grid is NULL in schedule_propagate.\n");
+        return RULE_CONFLICT;
+    }
+    rule_kind_t skipped = (kernels == &kernels_generic) ? RULES_SIZED : RULES_GENERIC;
+    schedule->kernels = kernels;
+    schedule->mark = mark;
+
+    int index = 0;
+    while (index < SCHEDULE_RULES) {
+        const t_rule* rule = &schedule_rules[index];
+        t_rule_yield* yield = &schedule->yield[index];
+        if (rule->tier > schedule->max_tier || rule->kind == skipped) {
+            index++;
+            continue;
+        }
+        if (yield->skip > 0) {
+            yield->skip--;
+            yield->skips++;
+            index++;
+            continue;
+        }
+
+        rule_result_t result;
+        if (rule->heuristic != NULL) {
+            result = rule->heuristic(g) ? RULE_CHANGED : RULE_STABLE;
+        }
+        else {
+            result = rule->apply(schedule, g);
+        }
+        schedule_record(yield, result);
+
+        if (result == RULE_CONFLICT) {
+            return RULE_CONFLICT;
+        }
+        index = (result == RULE_CHANGED) ? 0 : index + 1;
+    }
+    return RULE_STABLE;
+}
+
+
+/*
+ * Prints the yield of the rules that ran, one line each.
+ *
+ * Parameters:
+ * - schedule: Pointer to the scheduler.
+ * - fd: Output stream.
+ */
+void schedule_print(const t_schedule* schedule, FILE* fd) {
+    for (int i = 0; i < SCHEDULE_RULES; i++) {
+        const t_rule_yield* yield = &schedule->yield[i];
+        if (yield->runs == 0 && yield->skips == 0) {
+            continue;
+        }
+        fprintf(fd, "Rule %-16s %12llu runs, %12llu hits, %12llu skips\n", schedule_rules[i].name,
+                (unsigned long long)yield->runs, (unsigned long long)yield->hits,
+                (unsigned long long)yield->skips);
+    }
+}
+
+
+/*
+ * Parses the name of a propagation tier: "basic", "lines" or "probe".
+ *
+ * Parameters:
+ * - name: Name given on the command line.
+ * - tier: Receives the tier.
+ *
+ * Returns:
+ * true if the name is known, false otherwise.
+ */
+bool parse_propagation(const char* name, tier_t* tier) {
+    for (int i = 0; i <= TIER_PROBE; i++) {
+        if (strcmp(name, propagation_names[i]) == 0) {
+            *tier = (tier_t)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,1128 @@
+#include "../include/solver.h"
+#include "../include/dpcount.h"
+#include "../include/checkpoint.h"
+
+
+// Nodes between two reads of the clock and of the cancellation flag
+#define SOLVER_POLL_INTERVAL 256
+
+
+/*
+ * Milliseconds of a monotonic clock.
+ */
+static long solver_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+
+/*
+ * Checks whether a value ends a run of three identical cells in a line.
+ */
+static inline bool solver_makes_triple(const char* line, int length, int index, char value) {
+    int run = 1;
+    for (int k = index - 1; k >= 0 && k >= index - 2 && line[k] == value; k--) {
+        run++;
+    }
+    for (int k = index + 1; k < length && k <= index + 2 && line[k] == value; k++) {
+        run++;
+    }
+    return run >= 3;
+}
+
+
+/*
+ * Checks the row and the column of the last decision. The grid was consistent
+ * before it, so these are the only lines it can break: O(rows + cols) on the
+ * packed lines instead of a full consistency check.
+ *
+ * Parameters:
+ * - g: Pointer to the grid, holding the decision.
+ * - cell: Index of the decision cell.
+ *
+ * Returns:
+ * true if the grid is still consistent, false otherwise.
+ */
+static bool solver_decision_consistent(const t_grid* g, int cell) {
+    int row = cell / g->cols;
+    int col = cell - row * g->cols;
+    char value = g->grid[cell];
+    if (solver_makes_triple(g->grid + (size_t)row * g->cols, g->cols, col, value) ||
+        solver_makes_triple(g->columns + (size_t)col * g->rows, g->rows, row, value)) {
+        return false;
+    }
+
+    // Neither value may fill more than half of the row or of the column
+    int row_count = line_popcount(g->row_ones + (size_t)row * g->row_words, g->row_words);
+    int col_count = line_popcount(g->col_ones + (size_t)col * g->col_words, g->col_words);
+    if (value == '0') {
+        row_count = g->cols - g->row_empty[row] - row_count;
+        col_count = g->rows - g->col_empty[col] - col_count;
+    }
+    if (row_count > g->cols / 2 || col_count > g->rows / 2) {
+        return false;
+    }
+
+    // A line completed by the decision is in the sets of complete lines
+    return !grid_has_identical_lines(g);
+}
+
+
+/*
+ * Finds the first empty cell in row-major order, starting from a cell known to
+ * have only filled cells before it. A full grid is known from its count of empty
+ * cells, and full rows are skipped on theirs.
+ *
+ * Parameters:
+ * - g: Pointer to the grid.
+ * - from: Index of the cell where the scan starts.
+ *
+ * Returns:
+ * The index of the first empty cell, or -1 if the grid is full.
+ */
+static int solver_first_empty(const t_grid* g, int from) {
+    if (g->empty == 0) {
+        return -1;
+    }
+    for (int row = from / g->cols; row < g->rows; row++) {
+        if (g->row_empty[row] == 0) {
+            continue;
+        }
+        const uint64_t* filled = g->row_filled + (size_t)row * g->row_words;
+        for (int w = 0; w < g->row_words; w++) {
+            uint64_t empty = ~filled[w];
+            if (w == g->row_words - 1) {
+                empty &= line_last_mask(g->cols);
+            }
+            if (empty != 0) {
+                return row * g->cols + w * 64 + __builtin_ctzll(empty);
+            }
+        }
+    }
+    return -1;
+}
+
+
+/*
+ * Evaluates the current node: checks it, propagates it with the scheduler of the
+ * solver, and finds the cell to branch on. The root is checked and propagated with
+ * the functions of grid.c, so a grid without solution is left as they propagate it.
+ * Below the root, the grid was consistent before the last decision: only the lines
+ * of the decision are checked before the propagation, and the whole grid after it
+ * only if the propagation filled cells. The distinct lines and line completion
+ * rules only look at what changed since the decision.
+ *
+ * Parameters:
+ * - solver: Pointer to the solver.
+ * - cell: Receives the cell to branch on when the node is open.
+ *
+ * Returns:
+ * RULE_CONFLICT if the node is a dead end, RULE_SOLVED if the grid is a solution,
+ * RULE_STABLE if the node is open.
+ */
+static rule_result_t solver_evaluate(t_solver* solver, int* cell) {
+    t_grid* g = solver->grid;
+    const t_kernels* kernels = &kernels_generic;
+    int mark = -1;
+    int from = 0;
+    if (solver->depth == 0) {
+        if (!kernels->consistent(g)) {
+            LOG_INFO("The grid is inconsistent.\n");
+            return RULE_CONFLICT;
+        }
+    }
+    else {
+        const t_frame* frame = &solver->stack[solver->depth - 1];
+        kernels = solver->kernels;
+        mark = frame->mark;
+        from = frame->cell;
+        if (!solver_decision_consistent(g, frame->cell)) {
+            return RULE_CONFLICT;
+        }
+    }
+
+    int filled = g->trail_length;
+    if (schedule_propagate(&solver->schedule, g, kernels, mark) == RULE_CONFLICT) {
+        return RULE_CONFLICT;
+    }
+    if (g->trail_length != filled && !kernels->consistent(g)) {
+        return RULE_CONFLICT;
+    }
+
+    *cell = solver_first_empty(g, from);
+    return (*cell < 0) ? RULE_SOLVED : RULE_STABLE;
+}
+
+
+// Kinds of features of a state key
+#define KEY_FRONTIER    1ULL
+#define KEY_COLUMN      2ULL
+#define KEY_TOP_ROW     3ULL
+#define KEY_BOTTOM_ROW  4ULL
+#define KEY_COLUMN_PAIR 5ULL
+
+
+/*
+ * Zobrist key of a feature: a fixed 64-bit mixer, so no random table is needed.
+ */
+static inline uint64_t zobrist_key(uint64_t feature) {
+    feature = (feature ^ (feature >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    feature = (feature ^ (feature >> 27)) * 0x94D049BB133111EBULL;
+    return feature ^ (feature >> 31);
+}
+
+
+/*
+ * Check key of a feature: a mixer with other constants and a salted input, so that
+ * it is independent from zobrist_key and two states sharing a key are told apart.
+ */
+static inline uint64_t zobrist_check(uint64_t feature) {
+    feature ^= 0x9E3779B97F4A7C15ULL;
+    feature = (feature ^ (feature >> 33)) * 0xFF51AFD7ED558CCDULL;
+    feature = (feature ^ (feature >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+    return feature ^ (feature >> 33);
+}
+
+
+/*
+ * Checks if two columns can still end up identical: no row has a value in both
+ * columns that differs. As the full rows are filled, their values must be equal.
+ */
+static bool columns_may_match(const t_grid* g, int a, int b) {
+    const uint64_t* filled_a = g->col_filled + (size_t)a * g->col_words;
+    const uint64_t* filled_b = g->col_filled + (size_t)b * g->col_words;
+    const uint64_t* ones_a = g->col_ones + (size_t)a * g->col_words;
+    const uint64_t* ones_b = g->col_ones + (size_t)b * g->col_words;
+    for (int w = 0; w < g->col_words; w++) {
+        if (((ones_a[w] ^ ones_b[w]) & filled_a[w] & filled_b[w]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*
+ * Checks if a full row can still be equal to another row, i.e. agrees with every
+ * value already placed in that row.
+ */
+static bool row_may_match(const t_grid* g, int full, int row) {
+    const uint64_t* ones_a = g->row_ones + (size_t)full * g->row_words;
+    const uint64_t* filled_b = g->row_filled + (size_t)row * g->row_words;
+    const uint64_t* ones_b = g->row_ones + (size_t)row * g->row_words;
+    for (int w = 0; w < g->row_words; w++) {
+        if (((ones_a[w] ^ ones_b[w]) & filled_b[w]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*
+ * Computes the transposition key of a propagated state whose first empty cell is in
+ * row 'top'. Decisions fill the grid in row-major order, so the rows above are full
+ * and the solutions below the state only depend on:
+ * - the exact cells of the rows from 'top' down,
+ * - for each column, its number of '0' and its last two full values,
+ * - the full rows that some row below could still be equal to (a row below must
+ *   differ from them, the other full rows no longer constrain anything),
+ * - the pairs of columns that could still end up identical.
+ * States that only differ by the order of their full rows, or by full rows that can
+ * no longer be repeated, share a key: this is what makes subtrees reachable through
+ * several decision orders. The key XORs the Zobrist keys of these features, and the
+ * check word their zobrist_check keys.
+ *
+ * Parameters:
+ * - g: Pointer to the grid.
+ * - top: Row of the first empty cell.
+ * - check: Receives the 64-bit check word of the state.
+ *
+ * Returns:
+ * The 64-bit key of the state.
+ */
+static uint64_t solver_state_key(const t_grid* g, int top, uint64_t* check) {
+    uint64_t key = zobrist_key(KEY_FRONTIER << 60 | (uint64_t)top);
+    uint64_t verify = zobrist_check(KEY_FRONTIER << 60 | (uint64_t)top);
+
+    for (int row = 0; row < g->rows; row++) {
+        const uint64_t* filled = g->row_filled + (size_t)row * g->row_words;
+        const uint64_t* ones = g->row_ones + (size_t)row * g->row_words;
+        if (row < top) {
+            int below = top;
+            while (below < g->rows && !row_may_match(g, row, below)) {
+                below++;
+            }
+            if (below == g->rows) {
+                continue;
+            }
+        }
+
+        // Full rows hash their values only, the other rows their position as well
+        uint64_t feature = (row < top) ? KEY_TOP_ROW << 60 : (KEY_BOTTOM_ROW << 60 | (uint64_t)row);
+        uint64_t hash = zobrist_key(feature);
+        uint64_t hash_check = zobrist_check(feature);
+        for (int w = 0; w < g->row_words; w++) {
+            if (row >= top) {
+                hash = zobrist_key(hash ^ filled[w]);
+                hash_check = zobrist_check(hash_check ^ filled[w]);
+            }
+            hash = zobrist_key(hash ^ ones[w]);
+            hash_check = zobrist_check(hash_check ^ ones[w]);
+        }
+        key ^= hash;
+        verify ^= hash_check;
+    }
+
+    for (int col = 0; col < g->cols; col++) {
+        const uint64_t* ones = g->col_ones + (size_t)col * g->col_words;
+        int zeros = top;
+        for (int w = 0; w < top / 64; w++) {
+            zeros -= __builtin_popcountll(ones[w]);
+        }
+        if (top % 64 != 0) {
+            zeros -= __builtin_popcountll(ones[top / 64] & ((1ULL << (top % 64)) - 1));
+        }
+        uint64_t last = 0;
+        for (int i = top - 2; i < top; i++) {
+            last <<= 1;
+            if (i >= 0) {
+                last |= (ones[i / 64] >> (i % 64)) & 1;
+            }
+        }
+        uint64_t feature = KEY_COLUMN << 60 | (uint64_t)col << 32 | (uint64_t)zeros << 16 | last;
+        key ^= zobrist_key(feature);
+        verify ^= zobrist_check(feature);
+
+        for (int other = col + 1; other < g->cols; other++) {
+            if (columns_may_match(g, col, other)) {
+                uint64_t pair = KEY_COLUMN_PAIR << 60 | (uint64_t)col << 16 | (uint64_t)other;
+                key ^= zobrist_key(pair);
+                verify ^= zobrist_check(pair);
+            }
+        }
+    }
+    *check = verify;
+    return key;
+}
+
+
+/*
+ * Number of solutions a canonical solution stands for below a node where every
+ * symmetry is resolved: its orbit is then as large as the group.
+ */
+static inline uint64_t solver_weight(const t_solver* solver) {
+    return (solver->symmetry != NULL) ? (uint64_t)solver->symmetry->size : 1;
+}
+
+
+/*
+ * Checks that the current node can still lead to a canonical solution, i.e. that
+ * no symmetry maps its grid to a lexicographically smaller one. A symmetry whose
+ * image is found larger stays so in the whole subtree and is not compared again.
+ *
+ * Parameters:
+ * - solver: Pointer to the solver.
+ * - resolved: Output symmetries resolved at this node, the ones of its parent included.
+ *
+ * Returns:
+ * false if the node must be pruned, true otherwise.
+ */
+static bool solver_canonical(const t_solver* solver, uint32_t* resolved) {
+    *resolved = (solver->depth > 0) ? solver->stack[solver->depth - 1].resolved : 0;
+    for (int k = 1; k < solver->symmetry->size; k++) {
+        if (*resolved & (1U << k)) {
+            continue;
+        }
+        symmetry_order_t order = symmetry_compare(solver->grid, &solver->symmetry->transforms[k]);
+        if (order == SYMMETRY_LARGER) {
+            return false;
+        }
+        if (order == SYMMETRY_SMALLER) {
+            *resolved |= 1U << k;
+        }
+    }
+    return true;
+}
+
+
+/*
+ * Closes the current node: undoes the decisions whose both values were tried, then
+ * applies the other value of the deepest open decision.
+ *
+ * Parameters:
+ * - solver: Pointer to the solver.
+ *
+ * Returns:
+ * true if a new node is ready to be propagated, false if the search tree is exhausted.
+ */
+static bool solver_next_branch(t_solver* solver) {
+    t_grid* g = solver->grid;
+    while (solver->depth > 0) {
+        t_frame* frame = &solver->stack[solver->depth - 1];
+        grid_undo(g, frame->mark);
+        if (frame->open) {
+            frame->value = (frame->value == '0') ? '1' : '0';
+            frame->open = false;
+            grid_fill_cell(g, frame->cell / g->cols, frame->cell % g->cols, frame->value);
+            return true;
+        }
+
+        // Both values were tried: the subtree count is complete and can be memoized
+        if (solver->table != NULL && !frame->partial) {
+            tt_store(solver->table, frame->hash, frame->check,
+                (solver->solutions - frame->base) / solver_weight(solver), solver->empty_cells - frame->mark);
+        }
+        solver->depth--;
+    }
+    return false;
+}
+
+
+/*
+ * Prepares an iterative search over a grid. The grid is searched in place: its cells
+ * filled by the search are recorded on a trail and undone on backtrack, so no grid is
+ * copied per decision and the depth is only bounded by the size of the explicit stack.
+ *
+ * Parameters:
+ * - solver: Pointer to the solver to initialize.
+ * - grid: Pointer to the grid to search.
+ */
+void solver_init(t_solver* solver, t_grid* grid) {
+    solver->grid = grid;
+    // Every decision fills a different empty cell, so the stack never outgrows the grid
+    solver->stack = (t_frame*)malloc((size_t)grid->rows * grid->cols * sizeof(t_frame));
+    if (solver->stack == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in solver_init.\n");
+        exit(EXIT_FAILURE);
+    }
+    solver->depth = 0;
+    solver->backtrack = false;
+    solver->finished = false;
+    solver->nodes = 0;
+    solver->solutions = 0;
+    solver->max_nodes = 0;
+    solver->deadline = 0;
+    solver->cancel = NULL;
+    solver->pause_ms = 0;
+    solver->pause_at = 0;
+    solver->table = NULL;
+    solver->symmetry = NULL;
+    solver->rng = NULL;
+    solver->kernels = kernels_select(grid);
+    schedule_init(&solver->schedule, TIER_LINES, &(t_probe_limits){0, 0});
+    solver->empty_cells = grid->empty;
+    grid_trail_start(grid);
+}
+
+
+/*
+ * Frees the solver. The grid keeps its current cells (the last solution if the run
+ * returned SOLVER_SOLUTION) and stops recording a trail.
+ *
+ * Parameters:
+ * - solver: Pointer to the solver.
+ */
+void solver_free(t_solver* solver) {
+    grid_trail_stop(solver->grid);
+    free(solver->stack);
+    solver->stack = NULL;
+    solver->depth = 0;
+}
+
+
+/*
+ * Sets the budget of the search. Both limits count from this call: the time limit
+ * covers every run of the search, with the time spent between two runs, and the node
+ * budget adds to the nodes already propagated (by a resumed search, see checkpoint.h).
+ *
+ * Parameters:
+ * - solver: Pointer to the solver.
+ * - max_nodes: Number of nodes the search may still propagate (0: no limit).
+ * - timeout_ms: Time the search may take from now, in milliseconds (0: no limit).
+ */
+void solver_set_limits(t_solver* solver, uint64_t max_nodes, long timeout_ms) {
+    solver->max_nodes = (max_nodes > 0) ? solver->nodes + max_nodes : 0;
+    solver->deadline = (timeout_ms > 0) ? solver_now_ms() + timeout_ms : 0;
+}
+
+
+/*
+ * Makes the search stop when a flag is set, from another thread or a signal handler.
+ * The flag is read every SOLVER_POLL_INTERVAL nodes, so it costs nothing per node.
+ *
+ * Parameters:
+ * - solver: Pointer to the solver.
+ * - cancel: Pointer to the flag, NULL to never stop.
+ */
+void solver_set_cancel(t_solver* solver, const atomic_bool* cancel) {
+    solver->cancel = cancel;
+}
+
+
+/*
+ * Makes each run of the search pause at regular intervals with SOLVER_PAUSED, between
+ * two nodes, so that a long search can be saved (see checkpoint_write). The next run
+ * continues it as if it had not paused.
+ *
+ * Parameters:
+ * - solver: Pointer to the solver.
+ * - interval_ms: Time between two pauses in milliseconds (0: never pause).
+ */
+void solver_set_pause(t_solver* solver, long interval_ms) {
+    solver->pause_ms = interval_ms;
+    solver->pause_at = (interval_ms > 0) ? solver_now_ms() + interval_ms : 0;
+}
+
+
+/*
+ * Makes the search count solutions with a transposition table: the solution count of
+ * each fully explored subtree is stored under the key of its propagated state (see
+ * solver_state_key), and an equivalent state reached by another order of decisions
+ * adds its count without being explored. Solutions of memoized subtrees are counted in solver->solutions but not
+ * reported by solver_run, so this is only meant for counting.
+ *
+ * Parameters:
+ * - solver: Pointer to a solver not run yet.
+ * - table: Pointer to the table, NULL to enumerate every solution.
+ */
+void solver_set_table(t_solver* solver, t_ttable* table) {
+    solver->table = table;
+}
+
+
+/*
+ * Makes the search explore only the canonical solutions of the grid under a group of
+ * symmetries of its clues. Each canonical solution found counts for its whole orbit
+ * in solver->solutions; the other solutions of the orbit are its images by the group.
+ * With a transposition table, only the nodes where every symmetry is resolved are
+ * memoized, as the pruning above them depends on more than the key of their state.
+ *
+ * Parameters:
+ * - solver: Pointer to a solver not run yet.
+ * - symmetry: Pointer to the group, NULL to search every solution.
+ */
+void solver_set_symmetry(t_solver* solver, const t_symmetry* symmetry) {
+    solver->symmetry = (symmetry != NULL && symmetry->size > 1) ? symmetry : NULL;
+}
+
+
+/*
+ * Sets the rules that propagate every node: the basic rules, then the distinct lines
+ * and line completion rules, then failed-literal probing (see probe_grid), each tier
+ * only once the cheaper ones are stuck.
+ *
+ * Parameters:
+ * - solver: Pointer to a solver not run yet.
+ * - max_tier: Most expensive tier run (TIER_BASIC to TIER_PROBE).
+ * - depth: Nesting of the probes of the probe tier (0: no probing).
+ * - budget: Values tried per node and per round of probing (0: no limit).
+ */
+void solver_set_propagation(t_solver* solver, tier_t max_tier, int depth, long budget) {
+    schedule_init(&solver->schedule, max_tier, &(t_probe_limits){depth, budget});
+}
+
+
+/*
+ * Makes each decision try a random value first, so that the first solution found is a
+ * random one, as needed to generate grids. Restarting a search stopped by a node budget
+ * then explores another part of the tree.
+ *
+ * Parameters:
+ * - solver: Pointer to a solver not run yet.
+ * - rng: Random generator owned by the caller, NULL to try '0' first.
+ */
+void solver_set_random(t_solver* solver, t_rng* rng) {
+    solver->rng = rng;
+}
+
+
+/*
+ * Runs the search until the next solution, the end of the search tree or a limit.
+ * Decisions take the first empty cell in row-major order, '0' first, so solutions
+ * come in the same order as with the former recursive backtracking (unless
+ * solver_set_random draws the first value).
+ * A paused search keeps its stack and trail: calling solver_run again resumes it
+ * from the node where it stopped, possibly after raising the limits.
+ *
+ * Parameters:
+ * - solver: Pointer to the solver.
+ *
+ * Returns:
+ * SOLVER_SOLUTION with the solution in the grid, SOLVER_EXHAUSTED when there is no
+ * more solution, SOLVER_NODE_LIMIT, SOLVER_TIMEOUT, SOLVER_CANCELLED or SOLVER_PAUSED
+ * when the search is paused.
+ */
+solver_status_t solver_run(t_solver* solver) {
+    t_grid* g = solver->grid;
+
+    while (1) {
+        if (solver->finished) {
+            return SOLVER_EXHAUSTED;
+        }
+        if (solver->backtrack) {
+            if (!solver_next_branch(solver)) {
+                solver->finished = true;
+                return SOLVER_EXHAUSTED;
+            }
+            solver->backtrack = false;
+        }
+
+        // Limits are checked before a node is propagated, so a resumed run starts with it
+        if (solver->max_nodes > 0 && solver->nodes >= solver->max_nodes) {
+            return SOLVER_NODE_LIMIT;
+        }
+        if (solver->nodes % SOLVER_POLL_INTERVAL == 0) {
+            if (solver->cancel != NULL && atomic_load_explicit(solver->cancel, memory_order_relaxed)) {
+                return SOLVER_CANCELLED;
+            }
+            if (solver->deadline > 0 || solver->pause_ms > 0) {
+                long now = solver_now_ms();
+                if (solver->deadline > 0 && now >= solver->deadline) {
+                    return SOLVER_TIMEOUT;
+                }
+                if (solver->pause_ms > 0 && now >= solver->pause_at) {
+                    solver->pause_at = now + solver->pause_ms;
+                    return SOLVER_PAUSED;
+                }
+            }
+        }
+        solver->nodes++;
+
+        int cell = -1;
+        rule_result_t node = solver_evaluate(solver, &cell);
+        if (node == RULE_CONFLICT) {
+            solver->backtrack = true;
+            continue;
+        }
+
+        uint32_t resolved = 0;
+        if (solver->symmetry != NULL && !solver_canonical(solver, &resolved)) {
+            solver->backtrack = true;
+            continue;
+        }
+
+        if (node == RULE_SOLVED) {
+            solver->solutions += (solver->symmetry != NULL) ? (uint64_t)symmetry_orbit_size(g, solver->symmetry) : 1;
+            solver->backtrack = true;
+            return SOLVER_SOLUTION;
+        }
+
+        uint64_t key = 0;
+        uint64_t check = 0;
+        uint64_t count;
+        bool memoized = solver->symmetry == NULL || resolved == (1U << solver->symmetry->size) - 2;
+        if (solver->table != NULL && memoized) {
+            key = solver_state_key(g, cell / g->cols, &check);
+            if (tt_probe(solver->table, key, check, &count)) {
+                solver->solutions += count * solver_weight(solver);
+                solver->backtrack = true;
+                continue;
+            }
+        }
+
+        t_frame* frame = &solver->stack[solver->depth++];
+        frame->cell = cell;
+        frame->mark = g->trail_length;
+        frame->value = (solver->rng != NULL && rng_bit(solver->rng)) ? '1' : '0';
+        frame->open = true;
+        frame->partial = false;
+        frame->hash = key;
+        frame->check = check;
+        frame->base = solver->solutions;
+        frame->resolved = resolved;
+        grid_fill_cell(g, cell / g->cols, cell % g->cols, frame->value);
+    }
+}
+
+
+/*
+ * Tells whether a run of the search stopped before the end of its tree.
+ *
+ * Parameters:
+ * - status: Result of solver_run.
+ *
+ * Returns:
+ * true for SOLVER_NODE_LIMIT, SOLVER_TIMEOUT and SOLVER_CANCELLED.
+ */
+bool solver_stopped(solver_status_t status) {
+    return status == SOLVER_NODE_LIMIT || status == SOLVER_TIMEOUT || status == SOLVER_CANCELLED;
+}
+
+
+/*
+ * Splits the remaining work of a paused search: the shallowest open decision of the
+ * donor is given to the receiver, which explores the other value of that decision
+ * while the donor keeps the rest of its tree. The two searches then cover disjoint
+ * parts of the tree and can run on different threads.
+ *
+ * Parameters:
+ * - donor: Pointer to a paused solver.
+ * - receiver: Pointer to a solver initialized on a copy of the donor's original grid
+ *   and not run yet.
+ *
+ * Returns:
+ * true if work was given to the receiver, false if the donor has no open decision.
+ */
+bool solver_split(t_solver* donor, t_solver* receiver) {
+    if (donor->finished || donor->backtrack) {
+        return false;
+    }
+
+    int level = 0;
+    while (level < donor->depth && !donor->stack[level].open) {
+        level++;
+    }
+    if (level == donor->depth) {
+        return false;
+    }
+
+    // Replay the cells of the donor above the split level: its trail holds them in
+    // order, and its decisions sit at the marks of its frames
+    t_grid* g = receiver->grid;
+    const t_grid* source_grid = donor->grid;
+    receiver->depth = 0;
+    receiver->backtrack = false;
+    receiver->finished = false;
+    for (int k = 0; k <= level; k++) {
+        const t_frame* source = &donor->stack[k];
+        for (int t = g->trail_length; t < source->mark; t++) {
+            int cell = source_grid->trail[t];
+            grid_fill_cell(g, cell / g->cols, cell % g->cols, source_grid->grid[cell]);
+        }
+        t_frame* frame = &receiver->stack[receiver->depth++];
+        frame->cell = source->cell;
+        frame->mark = g->trail_length;
+        frame->value = (k < level) ? source->value : ((source->value == '0') ? '1' : '0');
+        frame->open = false;
+        frame->partial = true;
+        frame->hash = 0;
+        frame->check = 0;
+        frame->base = 0;
+        frame->resolved = 0;
+        grid_fill_cell(g, frame->cell / g->cols, frame->cell % g->cols, frame->value);
+    }
+    donor->stack[level].open = false;
+    for (int k = 0; k <= level; k++) {
+        donor->stack[k].partial = true;
+    }
+    return true;
+}
+
+
+/*
+ * Sets the propagation and the budget of the options on a solver not run yet.
+ */
+static void solver_configure(t_solver* solver, const takuzu_Options* options) {
+    solver_set_propagation(solver, options->propagation, options->probe_depth, options->probe_budget);
+    solver_set_limits(solver, options->max_nodes, options->timeout_ms);
+    solver_set_cancel(solver, options->cancel);
+}
+
+
+/*
+ * Puts a solver back in the state of the checkpoint of the options, with the budget
+ * counted from now, and gives back the position of the enumeration.
+ */
+static void solver_resume(t_solver* solver, const takuzu_Options* options, uint64_t* handed, t_grid* first) {
+    const t_checkpoint* checkpoint = options->resume;
+    checkpoint_restore(checkpoint, solver);
+    solver_set_limits(solver, options->max_nodes, options->timeout_ms);
+    if (handed != NULL) {
+        *handed = checkpoint->handed;
+    }
+    if (first != NULL && checkpoint->first != NULL) {
+        memcpy(first->grid, checkpoint->first, (size_t)first->rows * first->cols);
+        grid_sync_bits(first);
+    }
+}
+
+
+/*
+ * Fills the statistics of a solve, if they are asked for.
+ */
+static void solve_stats_fill(t_solve_stats* stats, solver_status_t status, uint64_t solutions,
+    const t_solver* solver, long started) {
+    if (stats != NULL) {
+        stats->status = status;
+        stats->solutions = solutions;
+        stats->nodes = solver->nodes;
+        stats->elapsed_ms = solver_now_ms() - started;
+        stats->saved = false;
+    }
+}
+
+
+/*
+ * Solves the grid in place and leaves the first solution in it. A search stopped by
+ * the budget of the options leaves the grid unchanged.
+ *
+ * Parameters:
+ * - grid: Pointer to the Takuzu grid.
+ * - options: Options of the search (propagation, probing and budget).
+ * - stats: Receives the outcome of the search, may be NULL.
+ *
+ * Returns:
+ * true if a solution was found, false if the grid has none or the search stopped.
+ */
+bool solve_first(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats) {
+    long started = solver_now_ms();
+    t_solver solver;
+    solver_init(&solver, grid);
+    solver_configure(&solver, options);
+    solver_status_t status = solver_run(&solver);
+    bool found = (status == SOLVER_SOLUTION);
+    if (solver_stopped(status)) {
+        grid_undo(grid, 0);
+    }
+    solve_stats_fill(stats, status, found ? 1 : 0, &solver, started);
+    solver_free(&solver);
+    return found;
+}
+
+
+/*
+ * Prepares a lazy enumeration of the solutions of a grid: the search only runs when the
+ * next solution is asked for, and is suspended in between. When the clues have
+ * symmetries, only canonical solutions are searched and each one is followed by its
+ * distinct images. An enumeration takes O(rows x cols) memory, whatever its length.
+ * The budget of the options covers the whole enumeration, from this call.
+ *
+ * Parameters:
+ * - iter: Pointer to the enumeration to initialize.
+ * - grid: Pointer to the Takuzu grid, searched in place until solution_iter_free.
+ * - options: Options of the search (propagation, probing and budget).
+ */
+void solution_iter_init(t_solution_iter* iter, t_grid* grid, const takuzu_Options* options) {
+    symmetry_detect(grid, &iter->symmetry);
+    iter->orbit = (char*)malloc((size_t)iter->symmetry.size * grid->rows * grid->cols);
+    if (iter->orbit == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in solution_iter_init.\n");
+        exit(EXIT_FAILURE);
+    }
+    LOG_INFO("Symmetries of the clues: %d\n", iter->symmetry.size);
+    grid_allocate(&iter->image, grid->rows, grid->cols);
+
+    solver_init(&iter->solver, grid);
+    solver_set_symmetry(&iter->solver, &iter->symmetry);
+    solver_configure(&iter->solver, options);
+    iter->transform = iter->symmetry.size;
+    iter->distinct = 0;
+    iter->handed = 0;
+    iter->exhausted = false;
+    iter->status = SOLVER_SOLUTION;
+}
+
+
+/*
+ * Resumes the enumeration up to its next solution.
+ *
+ * Parameters:
+ * - iter: Pointer to the enumeration.
+ *
+ * Returns:
+ * The next solution, valid until the next call, or NULL once every solution was handed
+ * out, when the budget stopped the search or at a pause (iter->status tells which).
+ */
+const t_grid* solution_iter_next(t_solution_iter* iter) {
+    const t_grid* grid = iter->solver.grid;
+    int cells = grid->rows * grid->cols;
+    while (true) {
+        // The identity comes first, so the canonical solution is handed out before its images
+        while (iter->transform < iter->symmetry.size) {
+            symmetry_apply(grid, &iter->symmetry.transforms[iter->transform++], &iter->image);
+            bool seen = false;
+            for (int d = 0; d < iter->distinct && !seen; d++) {
+                seen = memcmp(iter->orbit + (size_t)d * cells, iter->image.grid, cells) == 0;
+            }
+            if (!seen) {
+                memcpy(iter->orbit + (size_t)iter->distinct * cells, iter->image.grid, cells);
+                iter->distinct++;
+                iter->handed++;
+                return &iter->image;
+            }
+        }
+        if (iter->exhausted) {
+            return NULL;
+        }
+        iter->status = solver_run(&iter->solver);
+        if (iter->status != SOLVER_SOLUTION) {
+            iter->exhausted = (iter->status == SOLVER_EXHAUSTED);
+            return NULL;
+        }
+        iter->transform = 0;
+        iter->distinct = 0;
+    }
+}
+
+
+/*
+ * Frees an enumeration. The grid keeps its current cells.
+ *
+ * Parameters:
+ * - iter: Pointer to the enumeration.
+ */
+void solution_iter_free(t_solution_iter* iter) {
+    solver_free(&iter->solver);
+    free(iter->orbit);
+    iter->orbit = NULL;
+    symmetry_free(&iter->symmetry);
+    grid_free(&iter->image);
+}
+
+
+/*
+ * Enumerates the solutions of the grid and hands each one to a callback as soon as it
+ * is found. Solutions are not stored, so their number is only bounded by time. The
+ * grid is left filled with the first solution, or unchanged if the budget stopped the
+ * search before it.
+ * With options->checkpoint_file, the search is saved every CHECKPOINT_INTERVAL_MS and
+ * when it ends; with options->resume, it continues a saved search, whose solutions
+ * already handed out are not handed again.
+ *
+ * Parameters:
+ * - grid: Pointer to the Takuzu grid.
+ * - options: Options of the search (propagation, probing and budget).
+ * - callback: Called with each solution; returning false stops the enumeration.
+ * - data: Passed to the callback.
+ * - stats: Receives the outcome of the search, may be NULL.
+ *
+ * Returns:
+ * The number of solutions, or the number handed to the callback if the callback or
+ * the budget stopped the enumeration.
+ */
+uint64_t solve_all(t_grid* grid, const takuzu_Options* options, solution_callback_t callback, void* data,
+    t_solve_stats* stats) {
+    long started = solver_now_ms();
+    t_grid first;
+    grid_allocate(&first, grid->rows, grid->cols);
+
+    t_solution_iter iter;
+    solution_iter_init(&iter, grid, options);
+    if (options->resume != NULL) {
+        solver_resume(&iter.solver, options, &iter.handed, &first);
+    }
+    if (options->checkpoint_file != NULL) {
+        solver_set_pause(&iter.solver, CHECKPOINT_INTERVAL_MS);
+    }
+    bool stopped = false;
+    bool saved = false;
+    while (!stopped) {
+        const t_grid* solution = solution_iter_next(&iter);
+        if (solution == NULL) {
+            if (iter.status != SOLVER_PAUSED) {
+                break;
+            }
+            // A failed save keeps the previous checkpoint, the search goes on
+            saved = checkpoint_write(options->checkpoint_file, &iter.solver, options, iter.handed,
+                (iter.handed > 0) ? &first : NULL);
+            continue;
+        }
+        if (iter.handed == 1) {
+            grid_copy(solution, &first);
+        }
+        stopped = !callback(solution, iter.handed, data);
+    }
+    // A search stopped by the callback is in the middle of an orbit, it is not saved
+    if (options->checkpoint_file != NULL && !stopped) {
+        saved = checkpoint_write(options->checkpoint_file, &iter.solver, options, iter.handed,
+            (iter.handed > 0) ? &first : NULL);
+    }
+
+    uint64_t handed = iter.handed;
+    solver_status_t status = stopped ? SOLVER_SOLUTION : iter.status;
+    uint64_t solutions = (stopped || solver_stopped(status)) ? handed : iter.solver.solutions;
+    solve_stats_fill(stats, status, solutions, &iter.solver, started);
+    if (stats != NULL) {
+        stats->saved = saved;
+    }
+    if (solver_stopped(status)) {
+        grid_undo(grid, 0);
+    }
+    solution_iter_free(&iter);
+    if (handed > 0) {
+        grid_copy(&first, grid);
+    }
+    grid_free(&first);
+    return solutions;
+}
+
+
+/*
+ * Counts the solutions of the grid with a transposition table, without enumerating
+ * them. Symmetries of the clues are used as in solve_all, and so are the checkpoints.
+ *
+ * Parameters:
+ * - grid: Pointer to the Takuzu grid, left unchanged.
+ * - options: Options of the search (propagation, probing and budget).
+ * - stats: Receives the outcome of the search, may be NULL.
+ *
+ * Returns:
+ * The number of solutions, or the number counted so far if the budget stopped the search.
+ */
+uint64_t solve_count(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats) {
+    long started = solver_now_ms();
+    t_ttable table;
+    tt_init(&table, TT_DEFAULT_MB);
+
+    t_symmetry symmetry;
+    symmetry_detect(grid, &symmetry);
+
+    t_solver solver;
+    solver_init(&solver, grid);
+    solver_set_table(&solver, &table);
+    solver_set_symmetry(&solver, &symmetry);
+    solver_configure(&solver, options);
+    if (options->resume != NULL) {
+        solver_resume(&solver, options, NULL, NULL);
+    }
+    if (options->checkpoint_file != NULL) {
+        solver_set_pause(&solver, CHECKPOINT_INTERVAL_MS);
+    }
+    solver_status_t status;
+    bool saved = false;
+    while ((status = solver_run(&solver)) == SOLVER_SOLUTION || status == SOLVER_PAUSED) {
+        // Solutions are only counted, and the search is saved at each pause
+        if (status == SOLVER_PAUSED) {
+            saved = checkpoint_write(options->checkpoint_file, &solver, options, 0, NULL);
+        }
+    }
+    if (options->checkpoint_file != NULL) {
+        saved = checkpoint_write(options->checkpoint_file, &solver, options, 0, NULL);
+    }
+
+    uint64_t solutions = solver.solutions;
+    solve_stats_fill(stats, status, solutions, &solver, started);
+    if (stats != NULL) {
+        stats->saved = saved;
+    }
+    if (log_verbose) {
+        fprintf(stderr, "Symmetries: %d, nodes: %llu, table hits: %llu, table stores: %llu\n", symmetry.size,
+            (unsigned long long)solver.nodes, (unsigned long long)table.hits, (unsigned long long)table.stores);
+        schedule_print(&solver.schedule, stderr);
+    }
+    // Cells deduced at the root are still on the trail
+    grid_undo(grid, 0);
+    solver_free(&solver);
+    symmetry_free(&symmetry);
+    tt_free(&table);
+    return solutions;
+}
+
+
+/*
+ * Prints the result of a solve stopped by its budget, with what was searched so far.
+ *
+ * Parameters:
+ * - stats: Outcome of the solve.
+ */
+void print_stopped(const t_solve_stats* stats) {
+    printf("Number of solutions: unknown (%s)\n",
+        (stats->status == SOLVER_CANCELLED) ? "interrupted" : "budget exhausted");
+    printf("Partial search: %llu solutions found, %llu nodes, %ld ms\n", (unsigned long long)stats->solutions,
+        (unsigned long long)stats->nodes, stats->elapsed_ms);
+}
+
+
+/*
+ * Solves the grid in place, leaves the first solution in it and prints the result.
+ *
+ * Parameters:
+ * - grid: Pointer to the Takuzu grid.
+ * - options: Options of the command line.
+ * - stats: Receives the outcome of the search.
+ */
+void find_first_solution(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats) {
+    if (solve_first(grid, options, stats)) {
+        // Print the number of solutions
+        printf("Number of solutions: 1\n");
+
+        // Print the first solution
+        printf("Solution 1\n");
+    }
+    else if (solver_stopped(stats->status)) {
+        print_stopped(stats);
+    }
+    else {
+        printf("No solution found.\n");
+    }
+}
+
+
+/*
+ * Callback of find_all_solutions: prints a solution with its number.
+ */
+static bool print_solution(const t_grid* solution, uint64_t index, void* data) {
+    (void)data;
+    printf("Solution %llu\n", (unsigned long long)index);
+    grid_print(solution, stdout);
+    return true;
+}
+
+
+/*
+ * Prints every solution of the grid as soon as it is found, then their number.
+ * The grid is left filled with the first solution.
+ *
+ * Parameters:
+ * - grid: Pointer to the Takuzu grid.
+ * - options: Options of the command line.
+ * - stats: Receives the outcome of the search.
+ */
+void find_all_solutions(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats) {
+    uint64_t solutions = solve_all(grid, options, print_solution, NULL, stats);
+
+    // Print the number of solutions
+    if (solver_stopped(stats->status)) {
+        print_stopped(stats);
+    }
+    else {
+        printf("Number of solutions: %llu\n", (unsigned long long)solutions);
+    }
+}
+
+
+/*
+ * Counts the solutions of the grid and prints their number.
+ *
+ * Parameters:
+ * - grid: Pointer to the Takuzu grid.
+ * - options: Options of the command line.
+ * - stats: Receives the outcome of the search.
+ */
+void count_all_solutions(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats) {
+    uint64_t solutions = solve_count(grid, options, stats);
+    if (solver_stopped(stats->status)) {
+        print_stopped(stats);
+    }
+    else {
+        printf("Number of solutions: %llu\n", (unsigned long long)solutions);
+    }
+}
+
+
+/*
+ * Solves the grid according to the mode of the options: first solution only, or every solution.
+ *
+ * Parameters:
+ * - grid: Pointer to the Takuzu grid, modified in place.
+ * - options: Options of the command line; options->mode is MODE_FIRST, MODE_ALL,
+ *   MODE_COUNT or MODE_COUNT_DP.
+ * - stats: Receives the outcome of the search: solver_stopped(stats->status) tells
+ *   whether the budget stopped it, stats->saved whether it was saved to its checkpoint.
+ */
+void grid_solver(t_grid* grid, const takuzu_Options* options, t_solve_stats* stats) {
+    if (options->mode == MODE_FIRST) {
+        find_first_solution(grid, options, stats);
+    }
+    else if (options->mode == MODE_ALL) {
+        find_all_solutions(grid, options, stats);
+    }
+    else if (options->mode == MODE_COUNT) {
+        count_all_solutions(grid, options, stats);
+    }
+    else if (options->mode == MODE_COUNT_DP) {
+        count_solutions_dp(grid, options, stats);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "../include/swar8.h"
+
+
+/*
+ * An 8x8 grid fits in two words, one bit per cell, row i in byte i. The rules then
+ * run on the whole grid at once:
+ * - in rows, a cell and its right neighbour are one bit apart, and the shifts are
+ *   masked so that no bit crosses from one row to the next;
+ * - in columns, a cell and the one below are 8 bits apart, and the bits shifted
+ *   out of the word are simply lost;
+ * - the counts of the rows are popcounts of every byte at once, and the counts of
+ *   the columns the same on the transposed grid.
+ */
+
+#define BYTES_01 0x0101010101010101ULL
+#define BYTES_7F 0x7F7F7F7F7F7F7F7FULL
+#define BYTES_80 0x8080808080808080ULL
+#define BYTES_FE 0xFEFEFEFEFEFEFEFEULL
+#define BYTES_FC 0xFCFCFCFCFCFCFCFCULL
+#define BYTES_3F 0x3F3F3F3F3F3F3F3FULL
+
+
+/*
+ * Gathers the packed rows of an 8x8 grid into a board.
+ *
+ * Parameters:
+ * - g: Pointer to an 8x8 grid.
+ *
+ * Returns:
+ * The board of the grid.
+ */
+t_board8 swar8_load(const t_grid* g) {
+    t_board8 board = { 0, 0 };
+    for (int i = 0; i < 8; i++) {
+        board.filled |= g->row_filled[i] << (8 * i);
+        board.ones |= g->row_ones[i] << (8 * i);
+    }
+    return board;
+}
+
+
+/*
+ * Transposes an 8x8 bit matrix: bit 8 * i + j moves to bit 8 * j + i. Three rounds
+ * swap the off-diagonal 1x1, 2x2 and 4x4 blocks (Hacker's Delight, 7-3).
+ *
+ * Parameters:
+ * - x: The matrix.
+ *
+ * Returns:
+ * The transposed matrix.
+ */
+uint64_t swar8_transpose(uint64_t x) {
+    uint64_t t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+
+/*
+ * Counts the bits of every byte of a word at once.
+ */
+static inline uint64_t swar8_byte_counts(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    return (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+}
+
+
+/*
+ * Gives the bytes of a word holding 4, the half of a line, as 0xFF bytes.
+ */
+static inline uint64_t swar8_half_bytes(uint64_t counts) {
+    uint64_t t = counts ^ (4 * BYTES_01);
+    uint64_t zero = ~(((t & BYTES_7F) + BYTES_7F) | t) & BYTES_80;
+    return (zero >> 7) * 0xFF;
+}
+
+
+/*
+ * Gives the cells forced to the opposite value by the cells holding a value, in
+ * rows and in columns: next to a pair of them, or between two of them.
+ */
+static inline uint64_t swar8_forced(uint64_t v) {
+    uint64_t pairs = v & ((v >> 1) & BYTES_7F);
+    uint64_t rows = ((pairs << 2) & BYTES_FC) | ((pairs >> 1) & BYTES_7F) |
+        (((v << 1) & BYTES_FE) & ((v >> 1) & BYTES_7F));
+    uint64_t vertical = v & (v >> 8);
+    uint64_t columns = (vertical << 16) | (vertical >> 8) | ((v << 8) & (v >> 8));
+    return rows | columns;
+}
+
+
+/*
+ * Checks that the rows (or the columns, on a transposed board) do not exceed half
+ * of their cells with one value.
+ */
+static inline bool swar8_counts_consistent(uint64_t filled, uint64_t ones) {
+    uint64_t zeros = filled & ~ones;
+    return ((swar8_byte_counts(ones) + 0x7B * BYTES_01) & BYTES_80) == 0 &&
+        ((swar8_byte_counts(zeros) + 0x7B * BYTES_01) & BYTES_80) == 0;
+}
+
+
+/*
+ * Checks that the complete rows (or columns, on a transposed board) are distinct.
+ */
+static bool swar8_lines_distinct(uint64_t filled, uint64_t ones) {
+    for (int a = 1; a < 8; a++) {
+        if (((filled >> (8 * a)) & 0xFF) != 0xFF) {
+            continue;
+        }
+        for (int b = 0; b < a; b++) {
+            if (((filled >> (8 * b)) & 0xFF) == 0xFF && ((ones >> (8 * a)) & 0xFF) == ((ones >> (8 * b)) & 0xFF)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/*
+ * Checks the triples and the counts of a board, every rule but distinct lines.
+ */
+static bool swar8_board_rules_consistent(t_board8 board) {
+    uint64_t zeros = board.filled & ~board.ones;
+    for (int pass = 0; pass < 2; pass++) {
+        uint64_t v = (pass == 0) ? zeros : board.ones;
+        if ((v & (v >> 1) & (v >> 2) & BYTES_3F) != 0 || (v & (v >> 8) & (v >> 16)) != 0) {
+            return false;
+        }
+    }
+    return swar8_counts_consistent(board.filled, board.ones) &&
+        swar8_counts_consistent(swar8_transpose(board.filled), swar8_transpose(board.ones));
+}
+
+
+/*
+ * Checks the consistency of a board, with the same checks as is_consistent.
+ *
+ * Parameters:
+ * - board: The board.
+ *
+ * Returns:
+ * true if the board is consistent, false otherwise.
+ */
+bool swar8_board_consistent(t_board8 board) {
+    return swar8_board_rules_consistent(board) &&
+        swar8_lines_distinct(board.filled, board.ones) &&
+        swar8_lines_distinct(swar8_transpose(board.filled), swar8_transpose(board.ones));
+}
+
+
+/*
+ * Applies the basic rules to a board until none fills a cell. A cell forced to
+ * both values gets '1', which breaks the rule that forced '0' and is caught by
+ * the consistency check.
+ *
+ * Parameters:
+ * - board: The board.
+ *
+ * Returns:
+ * The propagated board.
+ */
+t_board8 swar8_board_propagate(t_board8 board) {
+    while (board.filled != ~0ULL) {
+        uint64_t empty = ~board.filled;
+        uint64_t zeros = board.filled & ~board.ones;
+        uint64_t set_one = swar8_forced(zeros);
+        uint64_t set_zero = swar8_forced(board.ones);
+
+        // Lines holding four values of a kind get the other value everywhere else
+        set_one |= swar8_half_bytes(swar8_byte_counts(zeros));
+        set_zero |= swar8_half_bytes(swar8_byte_counts(board.ones));
+        set_one |= swar8_transpose(swar8_half_bytes(swar8_byte_counts(swar8_transpose(zeros))));
+        set_zero |= swar8_transpose(swar8_half_bytes(swar8_byte_counts(swar8_transpose(board.ones))));
+
+        set_one &= empty;
+        set_zero &= empty & ~set_one;
+        if ((set_one | set_zero) == 0) {
+            break;
+        }
+        board.filled |= set_one | set_zero;
+        board.ones |= set_one;
+    }
+    return board;
+}
+
+
+/*
+ * Checks the consistency of an 8x8 grid on its board, asking the sets of complete
+ * lines of the grid for identical lines.
+ *
+ * Parameters:
+ * - g: Pointer to an 8x8 grid.
+ *
+ * Returns:
+ * true if the grid is consistent, false otherwise.
+ */
+bool swar8_consistent(t_grid* g) {
+    return !grid_has_identical_lines(g) && swar8_board_rules_consistent(swar8_load(g));
+}
+
+
+/*
+ * Propagates an 8x8 grid on its board, then writes the filled cells back into the
+ * grid, its packed lines, its counts of empty cells, its sets of complete lines and
+ * its trail.
+ *
+ * Parameters:
+ * - g: Pointer to an 8x8 grid.
+ *
+ * Returns:
+ * true if a cell was filled, false otherwise.
+ */
+bool swar8_propagate(t_grid* g) {
+    t_board8 board = swar8_load(g);
+    t_board8 result = swar8_board_propagate(board);
+    uint64_t filled = result.filled & ~board.filled;
+    if (filled == 0) {
+        return false;
+    }
+
+    while (filled != 0) {
+        int cell = __builtin_ctzll(filled);
+        filled &= filled - 1;
+        if (g->trail != NULL) {
+            g->trail[g->trail_length++] = cell;
+        }
+        grid_write_cell(g, cell / 8, cell % 8, ((result.ones >> cell) & 1) ? '1' : '0');
+        g->empty--;
+        g->row_empty[cell / 8]--;
+        g->col_empty[cell % 8]--;
+    }
+    for (int i = 0; i < 8; i++) {
+        g->row_filled[i] = (result.filled >> (8 * i)) & 0xFF;
+        g->row_ones[i] = (result.ones >> (8 * i)) & 0xFF;
+    }
+    uint64_t filled_columns = swar8_transpose(result.filled);
+    uint64_t ones_columns = swar8_transpose(result.ones);
+    for (int j = 0; j < 8; j++) {
+        g->col_filled[j] = (filled_columns >> (8 * j)) & 0xFF;
+        g->col_ones[j] = (ones_columns >> (8 * j)) & 0xFF;
+    }
+
+    // Lines completed by the propagation enter their sets, now that their bits are written
+    uint64_t old_columns = swar8_transpose(board.filled);
+    for (int k = 0; k < 8; k++) {
+        if (((board.filled >> (8 * k)) & 0xFF) != 0xFF && g->row_empty[k] == 0) {
+            lineset_insert(&g->full_rows, g->row_ones, 1, k);
+        }
+        if (((old_columns >> (8 * k)) & 0xFF) != 0xFF && g->col_empty[k] == 0) {
+            lineset_insert(&g->full_cols, g->col_ones, 1, k);
+        }
+    }
+    return true;
+}
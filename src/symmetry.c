@@ -0,0 +1,203 @@
+#include "../include/symmetry.h"
+
+
+/*
+ * The rules of Takuzu do not change when the grid is mirrored, rotated by a half
+ * turn, or, for a square grid, transposed or rotated by a quarter turn. They do not
+ * change either when every '0' becomes a '1' and every '1' a '0'. The transforms
+ * that also leave the clues unchanged map the solutions of the grid onto each
+ * other, so the search only needs the canonical solution of each orbit: the one
+ * smaller than all its images, comparing cells in row-major order with '0' < '1'.
+ */
+
+// Geometric transforms, the four last ones only for square grids
+enum {
+    GEOMETRY_IDENTITY,
+    GEOMETRY_MIRROR_COLUMNS,
+    GEOMETRY_MIRROR_ROWS,
+    GEOMETRY_HALF_TURN,
+    GEOMETRY_TRANSPOSE,
+    GEOMETRY_ANTI_TRANSPOSE,
+    GEOMETRY_QUARTER_TURN,
+    GEOMETRY_THREE_QUARTER_TURN,
+    GEOMETRY_COUNT
+};
+
+
+/*
+ * Gives the cell of the grid moved to a cell of the image by a geometric transform.
+ *
+ * Parameters:
+ * - geometry: Geometric transform.
+ * - rows: Number of rows of the grid.
+ * - cols: Number of columns of the grid.
+ * - i: Row of the cell of the image.
+ * - j: Column of the cell of the image.
+ *
+ * Returns:
+ * The index of the source cell.
+ */
+static int geometry_source(int geometry, int rows, int cols, int i, int j) {
+    switch (geometry) {
+    case GEOMETRY_MIRROR_COLUMNS:
+        return i * cols + (cols - 1 - j);
+    case GEOMETRY_MIRROR_ROWS:
+        return (rows - 1 - i) * cols + j;
+    case GEOMETRY_HALF_TURN:
+        return (rows - 1 - i) * cols + (cols - 1 - j);
+    case GEOMETRY_TRANSPOSE:
+        return j * cols + i;
+    case GEOMETRY_ANTI_TRANSPOSE:
+        return (cols - 1 - j) * cols + (rows - 1 - i);
+    case GEOMETRY_QUARTER_TURN:
+        return (cols - 1 - j) * cols + i;
+    case GEOMETRY_THREE_QUARTER_TURN:
+        return j * cols + (rows - 1 - i);
+    default:
+        return i * cols + j;
+    }
+}
+
+
+/*
+ * Gives the value of a cell of the image of a grid.
+ *
+ * Parameters:
+ * - grid: Pointer to the grid.
+ * - transform: Pointer to the transform.
+ * - cell: Index of the cell of the image.
+ *
+ * Returns:
+ * '0', '1' or '_'.
+ */
+static inline char symmetry_image_cell(const t_grid* grid, const t_transform* transform, int cell) {
+    char value = grid->grid[transform->source[cell]];
+    if (transform->complement && value != '_') {
+        value = (value == '0') ? '1' : '0';
+    }
+    return value;
+}
+
+
+/*
+ * Finds the transforms that leave the clues of a grid unchanged. They form a group,
+ * the identity being the first one.
+ *
+ * Parameters:
+ * - grid: Pointer to the grid.
+ * - symmetry: Pointer to the group to fill, to be freed with symmetry_free.
+ */
+void symmetry_detect(const t_grid* grid, t_symmetry* symmetry) {
+    int cells = grid->rows * grid->cols;
+    int geometries = (grid->rows == grid->cols) ? GEOMETRY_COUNT : GEOMETRY_TRANSPOSE;
+    symmetry->size = 0;
+
+    for (int complement = 0; complement <= 1; complement++) {
+        for (int geometry = 0; geometry < geometries; geometry++) {
+            t_transform* transform = &symmetry->transforms[symmetry->size];
+            transform->source = (int*)malloc(cells * sizeof(int));
+            if (transform->source == NULL) {
+                fprintf(stderr, "Error: Memory allocation failed in symmetry_detect.\n");
+                exit(EXIT_FAILURE);
+            }
+            transform->complement = complement;
+            for (int i = 0; i < grid->rows; i++) {
+                for (int j = 0; j < grid->cols; j++) {
+                    transform->source[i * grid->cols + j] = geometry_source(geometry, grid->rows, grid->cols, i, j);
+                }
+            }
+
+            bool kept = true;
+            for (int cell = 0; cell < cells && kept; cell++) {
+                kept = symmetry_image_cell(grid, transform, cell) == grid->grid[cell];
+            }
+            if (kept) {
+                symmetry->size++;
+            }
+            else {
+                free(transform->source);
+            }
+        }
+    }
+}
+
+
+/*
+ * Frees the transforms of a group.
+ *
+ * Parameters:
+ * - symmetry: Pointer to the group.
+ */
+void symmetry_free(t_symmetry* symmetry) {
+    for (int k = 0; k < symmetry->size; k++) {
+        free(symmetry->transforms[k].source);
+    }
+    symmetry->size = 0;
+}
+
+
+/*
+ * Compares a partial grid with its image, cell by cell in row-major order. The order
+ * is decided by the first cell where they differ, as long as no empty cell is met
+ * before it: a grid found larger than its image cannot be completed into a
+ * canonical solution, and one found smaller never needs to be compared again.
+ *
+ * Parameters:
+ * - grid: Pointer to the grid.
+ * - transform: Pointer to the transform.
+ *
+ * Returns:
+ * The order of the grid relative to its image.
+ */
+symmetry_order_t symmetry_compare(const t_grid* grid, const t_transform* transform) {
+    int cells = grid->rows * grid->cols;
+    for (int cell = 0; cell < cells; cell++) {
+        char value = grid->grid[cell];
+        char image = symmetry_image_cell(grid, transform, cell);
+        if (value == '_' || image == '_') {
+            return SYMMETRY_UNKNOWN;
+        }
+        if (value != image) {
+            return (value < image) ? SYMMETRY_SMALLER : SYMMETRY_LARGER;
+        }
+    }
+    return SYMMETRY_EQUAL;
+}
+
+
+/*
+ * Writes the image of a grid by a transform.
+ *
+ * Parameters:
+ * - grid: Pointer to the grid.
+ * - transform: Pointer to the transform.
+ * - image: Pointer to a grid of the same size receiving the image.
+ */
+void symmetry_apply(const t_grid* grid, const t_transform* transform, t_grid* image) {
+    int cells = grid->rows * grid->cols;
+    for (int cell = 0; cell < cells; cell++) {
+        image->grid[cell] = symmetry_image_cell(grid, transform, cell);
+    }
+    grid_sync_bits(image);
+}
+
+
+/*
+ * Computes the number of distinct images of a full grid, the size of its orbit.
+ *
+ * Parameters:
+ * - grid: Pointer to the full grid.
+ * - symmetry: Pointer to the group.
+ *
+ * Returns:
+ * The order of the group divided by the number of transforms fixing the grid.
+ */
+int symmetry_orbit_size(const t_grid* grid, const t_symmetry* symmetry) {
+    int fixed = 0;
+    for (int k = 0; k < symmetry->size; k++) {
+        if (symmetry_compare(grid, &symmetry->transforms[k]) == SYMMETRY_EQUAL) {
+            fixed++;
+        }
+    }
+    return symmetry->size / fixed;
+}
@@ -2,14 +2,86 @@
 #include "../include/grid.h"
 
 
+/*
+ * Function: is_valid_grid_size
+ * ----------------------------
+ * Checks if a number of rows/columns is a valid Takuzu grid size.
+ *
+ * Parameters:
+ *   - size: Number of rows/columns.
+ *
+ * Returns:
+ *   - true if the size is even and between 2 and MAX_GRID_SIZE, false otherwise.
+ */
+bool is_valid_grid_size(int size) {
+    return size >= 2 && size <= MAX_GRID_SIZE && size % 2 == 0;
+}
+
+
+/*
+ * Function: grid_allocate_lines
+ * -----------------------------
+ * Allocates the packed rows and columns of a grid whose dimensions are already set,
+ * and the column-major copy of its cells.
+ *
+ * Parameters:
+ *   - g: Pointer to the t_grid structure, with rows and cols set.
+ *
+ * Returns:
+ *   - None
+ *
+ * Notes:
+ *   - Exits the program with an error message if memory allocation fails.
+ *   - The packed rows and columns are allocated in a single block, all cells empty.
+ *   - The column-major copy, the sets of complete lines and the counts of empty
+ *     cells start as for an empty grid too; grid_sync_bits fills them from the cells.
+ */
+static void grid_allocate_lines(t_grid* g) {
+    g->row_words = LINE_WORDS(g->cols);
+    g->col_words = LINE_WORDS(g->rows);
+    g->row_filled = (uint64_t*)calloc(GRID_BIT_WORDS(g), sizeof(uint64_t));
+    if (g->row_filled == NULL) {
+        fprintf(stderr, "ERROR: Memory allocation for the grid failed. Exiting with error.\n");
+        exit(EXIT_FAILURE);
+    }
+    g->row_ones = g->row_filled + (size_t)g->rows * g->row_words;
+    g->col_filled = g->row_ones + (size_t)g->rows * g->row_words;
+    g->col_ones = g->col_filled + (size_t)g->cols * g->col_words;
+    g->columns = (char*)malloc((size_t)g->rows * g->cols);
+    if (g->columns == NULL) {
+        fprintf(stderr, "ERROR: Memory allocation for the grid failed. Exiting with error.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(g->columns, '_', (size_t)g->rows * g->cols);
+    g->row_empty = (int*)malloc(((size_t)g->rows + g->cols) * sizeof(int));
+    if (g->row_empty == NULL) {
+        fprintf(stderr, "ERROR: Memory allocation for the grid failed. Exiting with error.\n");
+        exit(EXIT_FAILURE);
+    }
+    g->col_empty = g->row_empty + g->rows;
+    for (int i = 0; i < g->rows; i++) {
+        g->row_empty[i] = g->cols;
+    }
+    for (int j = 0; j < g->cols; j++) {
+        g->col_empty[j] = g->rows;
+    }
+    g->empty = g->rows * g->cols;
+    lineset_init(&g->full_rows, g->rows);
+    lineset_init(&g->full_cols, g->cols);
+    g->trail = NULL;
+    g->trail_length = 0;
+}
+
+
 /*
  * Function: grid_allocate
  * -----------------------
- * Allocates memory for a Takuzu grid of the specified size and initializes it with '_'.
+ * Allocates memory for a Takuzu grid of the specified dimensions and initializes it with '_'.
  *
  * Parameters:
  *   - g: Pointer to the t_grid structure representing the Takuzu grid.
- *   - size: Size of the grid (number of rows/columns).
+ *   - rows: Number of rows of the grid.
+ *   - cols: Number of columns of the grid.
  *
  * Returns:
  *   - None
@@ -17,23 +89,23 @@
  * Notes:
  *   - Exits the program with an error message if memory allocation fails.
  */
-void grid_allocate(t_grid* g, int size) {
+void grid_allocate(t_grid* g, int rows, int cols) {
     // Allocate memory for the grid
-    g->grid = (char*)calloc(size * size, sizeof(char));
-
-    // Check if memory allocation was successful
+    g->grid = (char*)calloc((size_t)rows * cols, sizeof(char));
     if (g->grid == NULL) {
         fprintf(stderr, "ERROR: Memory allocation for the grid failed. Exiting with error.\n");
         exit(EXIT_FAILURE);
     }
 
     // Initialize the grid with '_' (underscore) characters
-    for (int i = 0; i < size * size; i++) {
+    for (size_t i = 0; i < (size_t)rows * cols; i++) {
         g->grid[i] = '_';
     }
 
-    // Set the grid size
-    g->size = size;
+    // Set the grid dimensions
+    g->rows = rows;
+    g->cols = cols;
+    grid_allocate_lines(g);
 }
 
 
@@ -58,6 +130,23 @@ void grid_free(t_grid* g) {
         // Set the grid pointer to NULL to avoid potential dangling pointers
         g->grid = NULL;
     }
+    if (g->row_filled != NULL) {
+        free(g->row_filled);
+        g->row_filled = NULL;
+        g->row_ones = NULL;
+        g->col_filled = NULL;
+        g->col_ones = NULL;
+    }
+    free(g->columns);
+    g->columns = NULL;
+    free(g->row_empty);
+    g->row_empty = NULL;
+    g->col_empty = NULL;
+    lineset_free(&g->full_rows);
+    lineset_free(&g->full_cols);
+    free(g->trail);
+    g->trail = NULL;
+    g->trail_length = 0;
 }
 
 
@@ -77,20 +166,20 @@ void grid_free(t_grid* g) {
  *   - '#' characters are omitted from the printed output.
  *   - Rows are separated by newline characters.
  */
-void grid_print(t_grid* g, FILE* fd) {
-    for (int row = 0; row < g->size; row++) {
-        for (int col = 0; col < g->size; col++) {
+void grid_print(const t_grid* g, FILE* fd) {
+    for (int row = 0; row < g->rows; row++) {
+        for (int col = 0; col < g->cols; col++) {
             // Print the grid element if it is not '#'
-            if (g->grid[row * g->size + col] != '#') {
-                fprintf(fd, "%c", g->grid[row * g->size + col]);
+            if (g->grid[row * g->cols + col] != '#') {
+                fprintf(fd, "%c", g->grid[row * g->cols + col]);
                 // If not the last element in the row, print a space as a separator
-                if (col < g->size - 1) {
+                if (col < g->cols - 1) {
                     fprintf(fd, " ");
                 }
             }
         }
         // Print a newline character only if the line had content
-        if (row < g->size) {
+        if (row < g->rows) {
             fprintf(fd, "\n");
         }
     }
@@ -118,186 +207,214 @@ bool check_char(const char c) {
 
 
 /*
- * Function: file_parser
- * ---------------------
- * Parses a Takuzu grid from a file and stores it in the given t_grid structure.
+ * Function: grid_reader_open
+ * --------------------------
+ * Opens a stream of grids for reading.
  *
  * Parameters:
- *   - grid: Pointer to the t_grid structure where the parsed grid will be stored.
- *   - filename: The name of the file containing the Takuzu grid.
+ *   - reader: Pointer to the t_grid_reader to initialize.
+ *   - filename: The name of the file containing the grids, "-" for the standard input.
+ *   - multiple: true if the grids are separated by blank lines, false for a single grid.
  *
  * Returns:
- *   - EXIT_SUCCESS if the file is successfully parsed, EXIT_FAILURE otherwise.
- *
- * Notes:
- *   - The function reads the file character by character, ignoring comments marked with '#'.
- *   - It validates the grid size and characters and handles potential errors during parsing.
- *   - The parsed grid is stored in the provided t_grid structure.
+ *   - true if the stream is open, false otherwise.
  */
-int file_parser(t_grid* grid, const char* filename) {
-    FILE* file = fopen(filename, "r");
+bool grid_reader_open(t_grid_reader* reader, const char* filename, bool multiple) {
+    FILE* file = (strcmp(filename, "-") == 0) ? stdin : fopen(filename, "r");
     if (file == NULL) {
         fprintf(stderr, "takuzu: error: Failed to open file\n");
-        return EXIT_FAILURE;
+        return false;
     }
+    grid_reader_attach(reader, file, multiple);
+    return true;
+}
+
+
+/*
+ * Function: grid_reader_attach
+ * ----------------------------
+ * Reads grids from a stream that is already open, e.g. a string opened with fmemopen.
+ *
+ * Parameters:
+ *   - reader: Pointer to the t_grid_reader to initialize.
+ *   - file: The stream; grid_reader_close closes it, unless it is the standard input.
+ *   - multiple: true if the grids are separated by blank lines, false for a single grid.
+ */
+void grid_reader_attach(t_grid_reader* reader, FILE* file, bool multiple) {
+    reader->file = file;
+    reader->line = NULL;
+    reader->capacity = 0;
+    reader->line_number = 0;
+    reader->multiple = multiple;
+    reader->error[0] = '\0';
+}
+
 
-    char line[MAX_GRID_SIZE] = "";
-    int gridSize = 0;
+/*
+ * Function: grid_reader_close
+ * ---------------------------
+ * Closes a stream of grids and frees its line buffer.
+ *
+ * Parameters:
+ *   - reader: Pointer to the t_grid_reader to close.
+ */
+void grid_reader_close(t_grid_reader* reader) {
+    free(reader->line);
+    reader->line = NULL;
+    if (reader->file != NULL && reader->file != stdin) {
+        fclose(reader->file);
+    }
+    reader->file = NULL;
+}
+
+
+/*
+ * Function: grid_read
+ * -------------------
+ * Reads the next Takuzu grid of a stream and stores it in the given t_grid structure.
+ *
+ * Parameters:
+ *   - reader: Pointer to an open t_grid_reader.
+ *   - grid: Pointer to the t_grid structure where the parsed grid will be stored.
+ *
+ * Returns:
+ *   - EXIT_SUCCESS if a grid was read, EOF if the stream holds no more grid,
+ *     EXIT_FAILURE if the grid is malformed, with the reason in reader->error.
+ *
+ * Notes:
+ *   - The stream is read one line at a time with getline, ignoring comments marked with '#'.
+ *   - The first line gives the number of columns; both dimensions can be any even number
+ *     up to MAX_GRID_SIZE, so grids can be rectangular.
+ *   - A grid runs until the end of the stream, or until a blank line if the reader was
+ *     opened for several grids. Otherwise blank lines are ignored.
+ *   - Cells are written straight into a buffer, grown as rows come, which becomes the grid.
+ *   - Nothing is printed, so that the library can parse quietly: the caller reports
+ *     reader->error.
+ */
+int grid_read(t_grid_reader* reader, t_grid* grid) {
+    char* cells = NULL;
+    size_t capacity = 0;
+    size_t length = 0;
+    int cols = 0;
     int row = 0;
-    bool started = false;
-    char caractere_parsed;
-
-    while (!started && (caractere_parsed = fgetc(file)) != EOF) {
-        // Ignore comments in the file
-        if (caractere_parsed == '#') {
-            while (caractere_parsed != EOF && caractere_parsed != '\n') {
-                caractere_parsed = fgetc(file);
+    ssize_t read;
+
+    while ((read = getline(&reader->line, &reader->capacity, reader->file)) != -1) {
+        reader->line_number++;
+
+        // Make room for the longest possible row: one cell per character of the line
+        if (length + (size_t)read > capacity) {
+            capacity = (capacity == 0) ? (size_t)read * 8 : capacity;
+            while (length + (size_t)read > capacity) {
+                capacity *= 2;
             }
+            char* grown = realloc(cells, capacity);
+            if (grown == NULL) {
+                fprintf(stderr, "ERROR: Memory allocation for the parser failed. Exiting with error.\n");
+                exit(EXIT_FAILURE);
+            }
+            cells = grown;
         }
-        else if (caractere_parsed == '\n') {
-            if (gridSize == 0) {
-                continue;
+
+        int gridSize = 0;
+        bool comment = false;
+        for (ssize_t k = 0; k < read && !comment; k++) {
+            char caractere_parsed = reader->line[k];
+            if (caractere_parsed == '#') {
+                comment = true;
             }
-            if (gridSize != 4 && gridSize != 8 && gridSize != 16 && gridSize != 32 && gridSize != 64) {
-                fprintf(stderr, "takuzu: error: line %d is malformed (wrong number of columns: %d)\n", row, gridSize);
-                fclose(file);
-                return EXIT_FAILURE;
+            else if (check_char(caractere_parsed)) {
+                cells[length + gridSize] = caractere_parsed;
+                gridSize++;
             }
-            else {
-                started = true;
-                grid_allocate(grid, gridSize);
+            else if (caractere_parsed != ' ' && caractere_parsed != '\t' &&
+                caractere_parsed != '\r' && caractere_parsed != '\n') {
+                snprintf(reader->error, sizeof(reader->error), "wrong character ‘%c’ at line %d!", caractere_parsed, reader->line_number);
+                free(cells);
+                return EXIT_FAILURE;
             }
         }
-        else if (check_char(caractere_parsed)) {
-            line[gridSize] = caractere_parsed;
-            gridSize++;
-        }
-        else if (caractere_parsed != ' ' && caractere_parsed != '\t') {
-            fprintf(stderr, "takuzu: error: wrong character ‘%c’ at line %d!\n", caractere_parsed, row);
-            fclose(file);
-            grid_free(grid);
-            return EXIT_FAILURE;
-        }
-    }
-    if (caractere_parsed == EOF) {
-        if (gridSize != 4 && gridSize != 8 && gridSize != 16 && gridSize != 32 && gridSize != 64) {
-            fprintf(stderr, "takuzu: error: line %d is malformed (wrong number of columns: %d)\n", row, gridSize);
-            fclose(file);
-            return EXIT_FAILURE;
-        }
-        else {
-            started = true;
-            grid_allocate(grid, gridSize);
-        }
-    }
-    // Copy the first line to the grid
-    for (int col = 0; col < gridSize; col++) {
-        grid->grid[col] = line[col];
-    }
 
-    row++;
-    gridSize = 0;
-    while ((caractere_parsed = fgetc(file)) != EOF) {
-        if (caractere_parsed == '#') {
-            while (caractere_parsed != EOF && caractere_parsed != '\n') {
-                caractere_parsed = fgetc(file);
+        if (gridSize == 0) {
+            // A blank line ends the current grid of a stream of several grids
+            if (reader->multiple && row > 0 && !comment) {
+                break;
             }
+            continue;
         }
-        else if (check_char(caractere_parsed)) {
-            line[row * grid->size + gridSize] = caractere_parsed;
-            gridSize++;
+        if (row == 0) {
+            // The first line gives the number of columns of the grid
+            cols = gridSize;
         }
-        else if (caractere_parsed == '\n') {
-            if (gridSize == 0) {
-                continue;
-            }
-            if (grid->size != gridSize) {
-                fprintf(stderr, "takuzu: error: line %d is malformed (wrong number of columns: %d)\n", row, gridSize);
-                grid_free(grid);
-                fclose(file);
-                return EXIT_FAILURE;
-            }
-            else {
-                for (int col = 0; col < grid->size; col++) {
-                    grid->grid[row * grid->size + col] = line[row * grid->size + col];
-                }
-                gridSize = 0;
-                row++;
-            }
+        if (gridSize != cols || !is_valid_grid_size(gridSize)) {
+            snprintf(reader->error, sizeof(reader->error), "line %d is malformed (wrong number of columns: %d)", reader->line_number, gridSize);
+            free(cells);
+            return EXIT_FAILURE;
         }
-        else if (caractere_parsed != ' ' && caractere_parsed != '\t') {
-            fprintf(stderr, "takuzu: error: wrong character ‘%c’ at line %d!\n", caractere_parsed, row);
-            grid_free(grid);
-            fclose(file);
+        if (row == MAX_GRID_SIZE) {
+            snprintf(reader->error, sizeof(reader->error), "line %d is malformed (more than %d rows)", reader->line_number, MAX_GRID_SIZE);
+            free(cells);
             return EXIT_FAILURE;
         }
+        length += gridSize;
+        row++;
     }
 
-    if (caractere_parsed == EOF && grid->size == gridSize) {
-        if (row < grid->size) {
-            // Copy the lines to the grid
-            for (int col = 0; col < grid->size; col++) {
-                grid->grid[row * grid->size + col] = line[row * grid->size + col];
-            }
-            row++;
-        }
-        else {
-            row++;
-        }
+    if (row == 0) {
+        free(cells);
+        return EOF;
     }
-    // Validate the number of rows in the file
-    if (row != grid->size) {
-        fprintf(stderr, "takuzu: error: Invalid number of rows in the file: row = %d et grid size = %d\n", row, grid->size);
-        grid_free(grid);
-        fclose(file);
+
+    // Validate the number of rows of the grid
+    if (!is_valid_grid_size(row)) {
+        snprintf(reader->error, sizeof(reader->error), "Invalid number of rows in the file: row = %d", row);
+        free(cells);
         return EXIT_FAILURE;
     }
 
-    fclose(file);
+    // The buffer holds exactly rows x cols cells and becomes the grid
+    grid->grid = cells;
+    grid->rows = row;
+    grid->cols = cols;
+    grid_allocate_lines(grid);
+    grid_sync_bits(grid);
     return EXIT_SUCCESS;
 }
 
 
 /*
- * Function: print_usage
+ * Function: file_parser
  * ---------------------
- * Print the usage information for the Takuzu program.
- */
-void print_usage() {
-    printf("\nUsage: takuzu [-a|-o FILE|-v|-h] FILE\n");
-    printf("takuzu -g[N] [-u|-o FILE|-v|-N|-h]\n");
-    printf("Solve or generate takuzu grids of size: 4, 8 16, 32, 64\n");
-    printf("-a, --all search for all possible solutions\n");
-    printf("-g[N], --generate[=N] generate a grid of size NxN (default: 8)\n");
-    printf("-o FILE, --output FILE write output to FILE\n");
-    printf("-u, --unique generate a grid with a unique solution\n");
-    printf("-v, --verbose verbose output\n");
-    printf("-n, --number%% to set the percentage of '0' and '1' characters in the grid (default: 50%%)\n");
-    printf("-h, --help display this help and exit\n");
-}
-
-
-/*
- * Function: output_to_file
- * ------------------------
- * Write the given content to the specified file.
+ * Parses a single Takuzu grid from a file and stores it in the given t_grid structure.
  *
  * Parameters:
- *   - filename: The name of the file to write to.
- *   - content: The content to write to the file.
+ *   - grid: Pointer to the t_grid structure where the parsed grid will be stored.
+ *   - filename: The name of the file containing the Takuzu grid.
+ *
+ * Returns:
+ *   - EXIT_SUCCESS if the file is successfully parsed, EXIT_FAILURE otherwise.
+ *
+ * Notes:
+ *   - The whole file is one grid: blank lines and comments marked with '#' are ignored.
  */
-void output_to_file(const char* filename, const char* content) {
-    FILE* file = fopen(filename, "w");
-    if (file == NULL) {
-        perror("Erreur lors de l'ouverture du fichier de sortie");
-        exit(EXIT_FAILURE);
+int file_parser(t_grid* grid, const char* filename) {
+    t_grid_reader reader;
+    if (!grid_reader_open(&reader, filename, false)) {
+        return EXIT_FAILURE;
     }
-    fputs(content, file);
-    fclose(file);
-}
 
+    int status = grid_read(&reader, grid);
+    if (status == EOF) {
+        fprintf(stderr, "takuzu: error: no grid in the file\n");
+        status = EXIT_FAILURE;
+    }
+    else if (status == EXIT_FAILURE) {
+        fprintf(stderr, "takuzu: error: %s\n", reader.error);
+    }
+    grid_reader_close(&reader);
+    return status;
+}
 
-takuzu_Options option; //variable for options
 
 /*
  * Function: initializeTakuzuOptions
@@ -314,207 +431,25 @@ void initializeTakuzuOptions(takuzu_Options* options) {
     options->all = false;
     options->generate_mode = false;
     options->number = 50;
-    options->grid_size = 8;
+    options->grid_rows = 8;
+    options->grid_cols = 8;
     options->mode = MODE_FIRST;
-}
-
-
-/*
- * Function: main
- * --------------
- *
- * Parameters:
- *   - argc: The number of command-line arguments.
- *   - argv: An array of strings representing the command-line arguments.
- *
- * Returns:
- *   - int: The exit status of the program.
- *
- * Notes:
- *   - Use -h for more informations
- */
-int main(int argc, char* argv[]) {
-    int c;
-    int option_index = 0;
-
-    initializeTakuzuOptions(&option);
-
-    static struct option long_options[] = {
-        {"all", no_argument, 0, 'a'},
-        {"generate", optional_argument, 0, 'g'},
-        {"unique", no_argument, 0, 'u'},
-        {"verbose", no_argument, 0, 'v'},
-        {"output", required_argument, 0, 'o'},
-        {"number", optional_argument, 0, 'n'},
-        {"help", no_argument, 0, 'h'},
-        {0, 0, 0, 0}
-    };
-
-    while ((c = getopt_long(argc, argv, "ag::o:uvn::h", long_options, &option_index)) != -1) {
-        switch (c) {
-        case 'a':
-            option.all = true;
-            option.mode = MODE_ALL;
-            break;
-        case 'g':
-            option.generate_mode = true;
-            if (optarg != NULL) { //if no parameter with g the size is by default 8 
-                int value = atoi(optarg);
-                if (value != 4 && value != 8 && value != 16 && value != 32 && value != 64) {
-                    fprintf(stderr, "Error: Invalid grid size specified for generation mode.\n");
-                    print_usage();
-                    exit(EXIT_FAILURE);
-                }
-                option.grid_size = value;
-            }
-            break;
-        case 'o':
-            if (optarg != NULL) { //if no parameter the output is stdout
-                option.output_file = optarg;
-            }
-            break;
-        case 'u':
-            option.unique = true;
-            if (option.unique) {
-                fprintf(stderr, "Mode generate grid with unique solution activate.\n");
-            }
-            break;
-        case 'v':
-            option.verbose = true;
-            if (option.verbose) {
-                fprintf(stderr, "Mode verbose output activate.\n");
-            }
-            break;
-        case 'n':
-            if (optarg != NULL) { //if no parameter with N the % is by default 50%
-                int number = atoi(optarg);
-                if (number < 0 || number > 100) {
-                    fprintf(stderr, "Error: Invalid N%% for the generation.\n");
-                    print_usage();
-                    exit(EXIT_FAILURE);
-                }
-                option.number = number;
-            }
-            break;
-        case 'h':
-            print_usage();
-            exit(EXIT_SUCCESS);
-        case '?':
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    if (argc == 1) {
-        fprintf(stderr, "Error: no input grid given!\n\n");
-        print_usage();
-        exit(EXIT_FAILURE);
-    }
-
-    if (option.unique && !option.generate_mode) {
-        fprintf(stderr, "warning: option 'unique' conflict with solver mode, exiting!\n\n");
-        print_usage();
-        exit(EXIT_FAILURE);
-    }
-
-    if (option.all && option.generate_mode) {
-        fprintf(stderr, "warning: option 'all' conflict with generate mode, exiting!\n\n");
-        print_usage();
-        exit(EXIT_FAILURE);
-    }
-
-    //We are un generate_mode
-    if (option.generate_mode) {
-        // Check if the grid size is specified
-        if (option.grid_size <= 0) {
-            fprintf(stderr, "Error: In generator mode, you need to specify a correct grid size.\n");
-            print_usage();
-            exit(EXIT_FAILURE);
-        }
-        t_grid generatedGrid;
-        grid_allocate(&generatedGrid, option.grid_size);
-        // Generate a random grid with the specified percentage 
-        if (option.unique) {
-            generate_random_grid_with_solution(&generatedGrid, option.number);  // You can adjust the percentage as needed with -n
-        }
-        else {
-            generate_random_grid(&generatedGrid, option.number);
-        }
-
-        if (option.verbose && is_consistent(&generatedGrid)) {
-            printf("\nWe generate a grid %d*%d with a generation of %d%%:\n\n", option.grid_size, option.grid_size, option.number);
-            printf("\nDon't pay attention of verbose message, the grid is consistent\n");
-        }
-        if (option.output_file != NULL) {
-            FILE* file = fopen(option.output_file, "w");
-            if (file == NULL) {
-                perror("Error when opening the file");
-                exit(EXIT_FAILURE);
-            }
-            grid_print(&generatedGrid, file);
-            fclose(file);
-        }
-        else {
-            // Write to stdout
-            grid_print(&generatedGrid, stdout);
-        }
-        grid_free(&generatedGrid);
-    }
-
-    // We are in solver mode, check if a grid file was provided as an argument
-    if (optind < argc) {
-        const char* filename = argv[optind];
-        t_grid myGridPars;
-
-        if (file_parser(&myGridPars, filename) == EXIT_SUCCESS) {
-            if (is_consistent(&myGridPars)) {
-                if (option.output_file != NULL) {
-                    FILE* file = fopen(option.output_file, "w");
-                    if (file == NULL) {
-                        perror("Error when opening the file");
-                        exit(EXIT_FAILURE);
-                    }
-                    if (is_valid(&myGridPars)) {
-                        printf("The grid is already valid.\n");
-                        grid_print(&myGridPars, file);
-                        fclose(file);
-                        grid_free(&myGridPars);
-                        exit(EXIT_SUCCESS);
-                    }
-                    else {
-                        grid_solver(&myGridPars, option.mode);
-                        grid_print(&myGridPars, file);
-                        fclose(file);
-                    }
-                }
-                else {
-                    if (is_valid(&myGridPars)) {
-                        printf("The grid is already valid.\n");
-                        grid_print(&myGridPars, stdout);
-                        grid_free(&myGridPars);
-                        exit(EXIT_SUCCESS);
-                    }
-                    else {
-                        grid_solver(&myGridPars, option.mode);
-
-                        grid_print(&myGridPars, stdout);// Write to stdout
-                        if (option.verbose && is_consistent(&myGridPars)) {
-                            printf("You activate Verbose, don't panic the grid is consistent\n");
-                        }
-                    }
-                }
-            }
-            else {
-                fprintf(stderr, "The grid is not consistent.\n");
-                grid_free(&myGridPars);
-                exit(EXIT_FAILURE);
-            }
-            grid_free(&myGridPars);
-        }
-        else {
-            fprintf(stderr, "\nFailed to parse grid from file '%s'\n", filename);
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    return 0;
+    options->count = 1;
+    options->jobs = 1;
+    options->seed = 0;
+    options->seed_given = false;
+    options->rate = false;
+    options->difficulty = TIER_BASIC;
+    options->difficulty_given = false;
+    options->batch = false;
+    options->probe_depth = 0;
+    options->probe_budget = 0;
+    options->propagation = TIER_LINES;
+    options->propagation_given = false;
+    options->max_nodes = 0;
+    options->timeout_ms = 0;
+    options->cancel = NULL;
+    options->checkpoint_file = NULL;
+    options->resume_file = NULL;
+    options->resume = NULL;
 }
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../include/ttable.h"
+
+
+/*
+ * Allocates a transposition table of at most the given memory. The number of buckets
+ * is rounded down to a power of two so that a hash selects its bucket with a mask.
+ *
+ * Parameters:
+ * - table: Pointer to the table to initialize.
+ * - megabytes: Memory budget of the table.
+ */
+void tt_init(t_ttable* table, size_t megabytes) {
+    size_t budget = megabytes * 1024 * 1024 / (TT_BUCKET_SIZE * sizeof(t_tt_entry));
+    size_t buckets = 1;
+    while (buckets * 2 <= budget) {
+        buckets *= 2;
+    }
+
+    table->entries = (t_tt_entry*)calloc(buckets * TT_BUCKET_SIZE, sizeof(t_tt_entry));
+    if (table->entries == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed in tt_init.\n");
+        exit(EXIT_FAILURE);
+    }
+    table->buckets = buckets;
+    table->age = 0;
+    table->hits = 0;
+    table->stores = 0;
+}
+
+
+/*
+ * Frees the entries of a transposition table.
+ *
+ * Parameters:
+ * - table: Pointer to the table.
+ */
+void tt_free(t_ttable* table) {
+    free(table->entries);
+    table->entries = NULL;
+    table->buckets = 0;
+}
+
+
+/*
+ * Looks up the solution count of a state.
+ *
+ * Parameters:
+ * - table: Pointer to the table.
+ * - key: Zobrist hash of the state.
+ * - check: Second hash of the state, compared with the stored one.
+ * - count: Output solution count, written on a hit.
+ *
+ * Returns:
+ * true if the state is in the table, false otherwise.
+ */
+bool tt_probe(t_ttable* table, uint64_t key, uint64_t check, uint64_t* count) {
+    t_tt_entry* bucket = table->entries + (key & (table->buckets - 1)) * TT_BUCKET_SIZE;
+    for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+        if (bucket[i].key == key && bucket[i].check == check && key != 0) {
+            *count = bucket[i].count;
+            table->hits++;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/*
+ * Stores the solution count of a state. When its bucket is full, the entry saving
+ * the smallest subtree is replaced, the oldest one among equals.
+ *
+ * Parameters:
+ * - table: Pointer to the table.
+ * - key: Zobrist hash of the state.
+ * - check: Second hash of the state.
+ * - count: Number of solutions below the state.
+ * - depth: Number of empty cells of the state.
+ */
+void tt_store(t_ttable* table, uint64_t key, uint64_t check, uint64_t count, int depth) {
+    if (key == 0) {
+        return;
+    }
+
+    t_tt_entry* bucket = table->entries + (key & (table->buckets - 1)) * TT_BUCKET_SIZE;
+    t_tt_entry* victim = &bucket[0];
+    for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+        if ((bucket[i].key == key && bucket[i].check == check) || bucket[i].key == 0) {
+            victim = &bucket[i];
+            break;
+        }
+        if (bucket[i].depth < victim->depth ||
+            (bucket[i].depth == victim->depth && bucket[i].age < victim->age)) {
+            victim = &bucket[i];
+        }
+    }
+
+    victim->key = key;
+    victim->check = check;
+    victim->count = count;
+    victim->depth = (uint32_t)depth;
+    victim->age = table->age++;
+    table->stores++;
+}